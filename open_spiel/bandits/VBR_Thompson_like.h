@@ -1,7 +1,8 @@
-#ifndef VBR_LIKE_V4
-#define VBR_LIKE_V4
+#ifndef VBR_THOMPSON_LIKE
+#define VBR_THOMPSON_LIKE
 
 #include <algorithm>
+#include <limits>
 #include <random>
 
 #include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
@@ -10,6 +11,7 @@
 #include "open_spiel/spiel_globals.h"
 #include "open_spiel/spiel_utils.h"
 #include "bandits/generic_policy.h"
+#include "bandits/running_stats.h"
 #include "bandits/utils.h"
 
 namespace policies {
@@ -19,7 +21,7 @@ namespace policies {
   class VBRThompsonLikePolicy : public GenericPolicy {
 
     private :
-      absl::flat_hash_map<std::pair<std::string, Action>, std::vector<double>> tab_;
+      ObservationTable tab_;
 
       std::random_device rd;
       std::mt19937 rng_{rd()};
@@ -29,22 +31,32 @@ namespace policies {
       double learning_rate; //Q-learning alpha
       double discount_factor; //Q-learning gamma
 
-      absl::flat_hash_map<std::pair<std::string, Action>, double>* qvalues = nullptr;
+      QTable* qvalues = nullptr;
 
       bool prev_history_based;
 
       StateAbstractionFunction abstraction_func;
 
-      double get_best_action_qvalue (State& state);
+      double get_best_action_qvalue (const StepContext& context);
 
     public :
-      virtual Action action_selection (const State& state);
+      virtual std::unique_ptr<GenericPolicy> Clone() const override;
 
-      virtual void reward_update (const State& state, Action& action, double reward);
+      virtual void SetSeed(uint32_t seed) override { rng_.seed(seed); }
 
-      VBRThompsonLikePolicy(double gamma = 2, double alpha = 0.01, bool history_based = false);
+      virtual Action action_selection (const StepContext& context);
 
-      void setQTableStructure(absl::flat_hash_map<std::pair<std::string, Action>, double>* table, double disc_factor, double learn_rate, StateAbstractionFunction func);
+      virtual void reward_update (const StepContext& context, Action& action, double reward, const StepContext* next_context);
+
+      VBRThompsonLikePolicy(double gamma = 2, double alpha = 0.01, bool history_based = false, StatsDecay decay = StatsDecay());
+
+      void setQTableStructure(QTable* table, double disc_factor, double learn_rate, StateAbstractionFunction func);
+
+      virtual void SaveState(open_spiel::CheckpointWriter* writer) const override;
+
+      virtual void LoadState(open_spiel::CheckpointReader* reader) override;
+
+      virtual size_t MemoryUsage() const override { return tab_.MemoryUsage(); }
 
       virtual std::string toString () const override;
 
@@ -11,16 +11,19 @@ namespace policies {
     }
   }
 
-  Action VBRLikePolicyV1::action_selection (const State& state) {
+  Action VBRLikePolicyV1::action_selection (const StepContext& context) {
 
       //printTab(tab_);
 
-      vector<Action> legal_actions = state.LegalActions();
+      const vector<Action>& legal_actions = context.legal_actions;
       vector<std::pair<Action, double>> mean_rewards;
 
+      //VBRLike1 non usa la funzione di astrazione, la tabella e' indicizzata con lo stato completo
+      const std::string& state_str = context.StateString();
+
       for (Action action : legal_actions) {
-        mean_rewards.push_back({action, tab_[std::make_pair(state.ToString(), action)].first});
-        // std::cout<<"ACTION "<<action<<" MEAN "<<tab_[std::make_pair(state.ToString(), action)].first<<std::endl;
+        mean_rewards.push_back({action, tab_[std::make_pair(state_str, action)].first});
+        // std::cout<<"ACTION "<<action<<" MEAN "<<tab_[std::make_pair(state_str, action)].first<<std::endl;
       }
 
       int max_mean_index;
@@ -66,11 +69,58 @@ namespace policies {
 
   }
 
-  void VBRLikePolicyV1::reward_update (const State& state, Action& action, double reward) {
-      double n_rewards = tab_[std::make_pair(state.ToString(), action)].second;
-      double old_mean = tab_[std::make_pair(state.ToString(), action)].first;
+  void VBRLikePolicyV1::reward_update (const StepContext& context, Action& action, double reward, const StepContext* next_context) {
+      std::pair<double, double>& stats = tab_[std::make_pair(context.StateString(), action)];
+      double n_rewards = stats.second;
+      double old_mean = stats.first;
       // std::cout<<" OLD MEAN" <<old_mean<< " N REWARDS "<<n_rewards<< " REWARD "<<reward<<" NEW MEAN "<<(old_mean*n_rewards/(n_rewards+1.0))+(reward/(n_rewards+1.0))<<std::endl;
-      tab_[std::make_pair(state.ToString(), action)] = std::make_pair((old_mean*n_rewards/(n_rewards+1.0))+(reward/(n_rewards+1.0)), n_rewards+1.0);
+      stats = std::make_pair((old_mean*n_rewards/(n_rewards+1.0))+(reward/(n_rewards+1.0)), n_rewards+1.0);
+  }
+
+  std::unique_ptr<GenericPolicy> VBRLikePolicyV1::Clone() const {
+    return std::make_unique<VBRLikePolicyV1>();
+  }
+
+  void VBRLikePolicyV1::SaveState(open_spiel::CheckpointWriter* writer) const {
+    //Ordinate per chiave, cosi' la stessa tabella da' lo stesso file
+    std::vector<std::pair<std::string, Action>> keys;
+    keys.reserve(tab_.size());
+    for (const auto& [key, stats] : tab_)
+      keys.push_back(key);
+    std::sort(keys.begin(), keys.end());
+
+    writer->Write<uint64_t>(keys.size());
+    for (const auto& key : keys) {
+      const std::pair<double, double>& stats = tab_.at(key);
+      writer->WriteString(key.first);
+      writer->Write<int64_t>(key.second);
+      writer->Write<double>(stats.first);
+      writer->Write<double>(stats.second);
+    }
+    writer->WriteEngine(rng_);
+  }
+
+  void VBRLikePolicyV1::LoadState(open_spiel::CheckpointReader* reader) {
+    tab_.clear();
+    const uint64_t n_entries = reader->Read<uint64_t>();
+    for (uint64_t i = 0; i < n_entries; i++) {
+      std::string state = reader->ReadString();
+      Action action = reader->Read<int64_t>();
+      double first = reader->Read<double>();
+      double second = reader->Read<double>();
+      tab_[{std::move(state), action}] = {first, second};
+    }
+    reader->ReadEngine(&rng_);
+  }
+
+  size_t VBRLikePolicyV1::MemoryUsage() const {
+    //Un byte di controllo per slot, piu' gli stati non memorizzati nella stringa stessa
+    size_t bytes = tab_.capacity() * (sizeof(decltype(tab_)::value_type) + 1);
+    for (const auto& [key, value] : tab_) {
+      if (key.first.capacity() > std::string().capacity())
+        bytes += key.first.capacity() + 1;
+    }
+    return bytes;
   }
 
   std::string VBRLikePolicyV1::toString () const {
@@ -21,9 +21,19 @@ namespace policies {
       std::mt19937 rng_;
 
     public :
-      virtual Action action_selection (const State& state) override;
+      virtual std::unique_ptr<GenericPolicy> Clone() const override;
 
-      virtual void reward_update (const State& state, Action& action, double reward) override;
+      virtual void SetSeed(uint32_t seed) override { rng_.seed(seed); }
+
+      virtual Action action_selection (const StepContext& context) override;
+
+      virtual void reward_update (const StepContext& context, Action& action, double reward, const StepContext* next_context) override;
+
+      virtual void SaveState(open_spiel::CheckpointWriter* writer) const override;
+
+      virtual void LoadState(open_spiel::CheckpointReader* reader) override;
+
+      virtual size_t MemoryUsage() const override;
 
       virtual std::string toString () const override;
 
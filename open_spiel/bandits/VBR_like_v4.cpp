@@ -6,48 +6,38 @@ using policies::standard_deviation_calc;
 
 namespace policies {
 
-  double VBRLikePolicyV4::get_best_action_qvalue(State& state) {
-
-    if (state.IsTerminal()) {
-      return 0;
-    }
-
-    vector<Action> legal_actions = state.LegalActions();
-    const auto state_str = abstraction_func(state.ToString());
-
-    Action best_action = legal_actions[0];
-    double value = (*qvalues)[{state_str, best_action}];
-    for (const Action& action : legal_actions) {
-      double q_val = (*qvalues)[{state_str, action}];
-      if (q_val >= value) {
-        value = q_val;
-        best_action = action;
-      }
-    }
+  double VBRLikePolicyV4::get_best_action_qvalue(const StepContext& context) {
+
+    const vector<Action>& legal_actions = context.legal_actions;
 
-    return value;
+    return qvalues->GreedyAction(context.state_id, legal_actions,
+                                 -std::numeric_limits<double>::infinity(),
+                                 legal_actions[0]).value;
   }
 
-  Action VBRLikePolicyV4::action_selection (const State& state) {
+  Action VBRLikePolicyV4::action_selection (const StepContext& context) {
 
-      vector<Action> legal_actions = state.LegalActions();
+      const vector<Action>& legal_actions = context.legal_actions;
       absl::flat_hash_map<Action, double> sample;
 
       if (legal_actions.empty())
         return open_spiel::kInvalidAction;
 
-      for (Action action : legal_actions) {
+      QRowBuffer qvalues_buffer;
+      absl::Span<const double> qvalues_row = qvalues->Row(context.state_id, &qvalues_buffer);
 
-        vector<double> observation_list = tab_[{abstraction_func(state.ToString()), action}];
+      for (Action action : legal_actions) {
 
-        double n_observations = observation_list.size();
+        const RunningStats& observations = tab_.Get(context.state_id, action);
 
-        if (n_observations < 2) {
+        if (observations.count < 2) {
           return action;
         }
 
-        double mean = (*qvalues)[{abstraction_func(state.ToString()), action}];
-        double standard_deviation = standard_deviation_calc(observation_list, mean);
+        double n_observations = observations.weight;
+
+        double mean = qvalues_row[action];
+        double standard_deviation = standard_deviation_calc(observations, mean);
 
         double standard_error = standard_deviation/sqrt(n_observations);
 
@@ -71,35 +61,54 @@ namespace policies {
 
   }
 
-  void VBRLikePolicyV4::reward_update (const State& state, Action& action, double reward) {
+  void VBRLikePolicyV4::reward_update (const StepContext& context, Action& action, double reward, const StepContext* next_context) {
 
-      std::unique_ptr<State> next_state = state.Child(action);
-      double max_next_q_value = get_best_action_qvalue(*next_state);
+      //Lo stato successivo e' quello osservato dal solver, non lo ricalcoliamo con Child
+      double max_next_q_value = (next_context == nullptr ? 0 : get_best_action_qvalue(*next_context));
       double new_observation;
       if (prev_history_based)
-        new_observation = (1-learning_rate) * ((*qvalues)[{abstraction_func(state.ToString()), action}]) + learning_rate * (reward + discount_factor * max_next_q_value);
+        new_observation = (1-learning_rate) * (qvalues->Value(context.state_id, action)) + learning_rate * (reward + discount_factor * max_next_q_value);
       else
         new_observation = reward + discount_factor * max_next_q_value;
 
     //   std::cout<<" OLD MEAN" <<old_mean<< " N REWARDS "<<n_rewards<< " REWARD "<<reward<<" NEW MEAN "<<(old_mean*n_rewards/(n_rewards+1.0))+(reward/(n_rewards+1.0))<<std::endl;
-      tab_[{abstraction_func(state.ToString()), action}].push_back(new_observation);
+      tab_.Add(context.state_id, action, new_observation);
   }
 
-  void VBRLikePolicyV4::setQTableStructure(absl::flat_hash_map<std::pair<std::string, Action>, double>* table, double disc_factor, double learn_rate, StateAbstractionFunction func){
+  void VBRLikePolicyV4::setQTableStructure(QTable* table, double disc_factor, double learn_rate, StateAbstractionFunction func){
       qvalues = table;
       discount_factor = disc_factor;
       abstraction_func = func;
+      tab_.Clear(); //Le osservazioni sono indicizzate con gli id della tabella precedente
   }
 
-  VBRLikePolicyV4::VBRLikePolicyV4(double gamma, double alpha, bool history_based){
+  VBRLikePolicyV4::VBRLikePolicyV4(double gamma, double alpha, bool history_based, StatsDecay decay) : tab_(decay) {
     confidence_parameter = gamma;
     prev_history_based = history_based;
     learning_rate = alpha;
   }
 
+  std::unique_ptr<GenericPolicy> VBRLikePolicyV4::Clone() const {
+    return std::make_unique<VBRLikePolicyV4>(confidence_parameter, learning_rate, prev_history_based, tab_.decay());
+  }
+
+  void VBRLikePolicyV4::SaveState(open_spiel::CheckpointWriter* writer) const {
+    tab_.Save(writer);
+    writer->WriteEngine(rng_);
+  }
+
+  void VBRLikePolicyV4::LoadState(open_spiel::CheckpointReader* reader) {
+    tab_.Load(reader);
+    reader->ReadEngine(&rng_);
+  }
+
   std::string VBRLikePolicyV4::toString () const {
     std::stringstream s;
     s << "VBRThompsonLike (" << (prev_history_based ? "history" : "no history") << ") alfa(" << learning_rate << ")";
+    if (tab_.decay().factor != 1)
+      s << " decay(" << tab_.decay().factor << ")";
+    if (tab_.decay().window > 0)
+      s << " window(" << tab_.decay().window << ")";
     return s.str();
   }
 
@@ -0,0 +1,94 @@
+
+#include "abstraction_cache.h"
+
+#include <functional>
+
+#include "open_spiel/spiel_utils.h"
+
+namespace policies {
+
+  AbstractionCache::AbstractionCache(StateAbstractionFunction func, int capacity)
+      : func_(std::move(func)), capacity_(capacity) {
+    SPIEL_CHECK_GT(capacity, 0);
+    entries_.reserve(capacity);
+    slots_.reserve(capacity);
+  }
+
+  std::string AbstractionCache::Apply(const std::string& raw_state) {
+    const size_t hash = std::hash<std::string>()(raw_state);
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = slots_.find(hash);
+    if (it != slots_.end()) {
+      Entry& entry = entries_[it->second];
+      if (entry.raw_state == raw_state) {
+        counters_.hits++;
+        entry.referenced = true;
+        return entry.abstracted;
+      }
+      //Collisione dell'hash: lo stato nuovo prende il posto del vecchio
+      counters_.misses++;
+      entry.raw_state = raw_state;
+      entry.abstracted = func_(raw_state);
+      entry.referenced = true;
+      return entry.abstracted;
+    }
+
+    counters_.misses++;
+    int slot = FreeSlot();
+    entries_[slot] = Entry{raw_state, func_(raw_state), false};
+    slots_[hash] = slot;
+    return entries_[slot].abstracted;
+  }
+
+  int AbstractionCache::FreeSlot() {
+    if ((int)entries_.size() < capacity_) {
+      entries_.emplace_back();
+      return entries_.size() - 1;
+    }
+    //Seconda possibilita': si salta (azzerandolo) ogni elemento usato dall'ultimo passaggio della lancetta
+    while (entries_[hand_].referenced) {
+      entries_[hand_].referenced = false;
+      hand_ = (hand_ + 1) % capacity_;
+    }
+    int slot = hand_;
+    hand_ = (hand_ + 1) % capacity_;
+    slots_.erase(std::hash<std::string>()(entries_[slot].raw_state));
+    counters_.evictions++;
+    return slot;
+  }
+
+  AbstractionCache::Counters AbstractionCache::GetCounters() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return counters_;
+  }
+
+  void AbstractionCache::ResetCounters() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_ = Counters();
+  }
+
+  int AbstractionCache::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  void AbstractionCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    slots_.clear();
+    hand_ = 0;
+  }
+
+  StateAbstractionFunction MemoizedAbstraction(
+      StateAbstractionFunction func, int capacity,
+      std::shared_ptr<AbstractionCache>* cache) {
+    auto shared_cache = std::make_shared<AbstractionCache>(std::move(func), capacity);
+    if (cache != nullptr)
+      *cache = shared_cache;
+    return [shared_cache](const std::string raw_state) {
+      return shared_cache->Apply(raw_state);
+    };
+  }
+
+}
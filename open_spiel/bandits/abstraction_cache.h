@@ -0,0 +1,76 @@
+#ifndef ABSTRACTION_CACHE_H
+#define ABSTRACTION_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "bandits/generic_policy.h"
+
+namespace policies {
+
+  // Bounded memoization of a StateAbstractionFunction: remembers the
+  // abstraction of up to capacity raw state strings, keyed by their hash, and
+  // evicts with the clock (second chance) algorithm, an approximation of LRU
+  // that marks entries on hit instead of reordering a list.
+  // A repeated state costs one hash probe and a string comparison instead of
+  // a call to the abstraction. Calls are serialized by a mutex, so one cache
+  // can be shared between threads.
+  class AbstractionCache {
+    public :
+      struct Counters {
+        int64_t hits = 0;
+        int64_t misses = 0;
+        int64_t evictions = 0;
+
+        double HitRate() const {
+          return hits + misses == 0 ? 0 : (double)hits / (hits + misses);
+        }
+      };
+
+      AbstractionCache(StateAbstractionFunction func, int capacity);
+
+      // func(raw_state), from the cache if possible.
+      std::string Apply(const std::string& raw_state);
+
+      Counters GetCounters() const;
+      void ResetCounters();
+
+      int Size() const;
+      int Capacity() const { return capacity_; }
+
+      // Forgets all entries, keeping the counters.
+      void Clear();
+
+    private :
+      struct Entry {
+        std::string raw_state;
+        std::string abstracted;
+        bool referenced;
+      };
+
+      // Slot where a new entry can be stored, evicting one if the cache is full.
+      int FreeSlot();
+
+      StateAbstractionFunction func_;
+      int capacity_;
+      mutable std::mutex mutex_;
+      std::vector<Entry> entries_;
+      absl::flat_hash_map<size_t, int> slots_; // Hash dello stato -> indice in entries_
+      int hand_ = 0;
+      Counters counters_;
+  };
+
+  // Wraps func in a new AbstractionCache of the given capacity. The returned
+  // function can be used wherever func is; if cache is not null it receives
+  // the cache, e.g. to read its counters.
+  StateAbstractionFunction MemoizedAbstraction(
+      StateAbstractionFunction func, int capacity,
+      std::shared_ptr<AbstractionCache>* cache = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,121 @@
+
+#include "distance_field.h"
+
+#include <functional>
+#include <mutex>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/spiel_utils.h"
+
+namespace policies {
+
+  namespace {
+
+    struct CachedField {
+      std::string grid;  // Per distinguire le collisioni dell'hash.
+      std::shared_ptr<const DistanceField> field;
+      bool referenced;
+    };
+
+    //Stessa politica di AbstractionCache: clock (seconda possibilita')
+    struct FieldCache {
+      std::mutex mutex;
+      std::vector<CachedField> entries;
+      absl::flat_hash_map<size_t, int> slots; // Hash della griglia -> indice in entries
+      int hand = 0;
+
+      int FreeSlot() {
+        if ((int)entries.size() < DistanceField::kCacheCapacity) {
+          entries.emplace_back();
+          return entries.size() - 1;
+        }
+        while (entries[hand].referenced) {
+          entries[hand].referenced = false;
+          hand = (hand + 1) % DistanceField::kCacheCapacity;
+        }
+        int slot = hand;
+        hand = (hand + 1) % DistanceField::kCacheCapacity;
+        slots.erase(std::hash<std::string>()(entries[slot].grid));
+        return slot;
+      }
+    };
+
+    FieldCache& Cache() {
+      static auto* cache = new FieldCache();
+      return *cache;
+    }
+
+  }
+
+  DistanceField::DistanceField(const MazeGrid& grid)
+      : n_rows_(grid.n_rows()), n_columns_(grid.n_columns()),
+        distances_(grid.NumCells(), kUnreachable) {
+    const int destination = grid.Find('A');
+    SPIEL_CHECK_GE(destination, 0);
+
+    //Coda su un vettore: ogni cella entra al piu' una volta
+    std::vector<int> queue(grid.NumCells());
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = destination;
+    distances_[destination] = 0;
+    while (head < tail) {
+      const int curr = queue[head++];
+      const int row = curr / n_columns_;
+      const int column = curr % n_columns_;
+      const int next_distance = distances_[curr] + 1;
+      auto visit = [&](int next) {
+        if (distances_[next] == kUnreachable && grid.At(next) != '*') {
+          distances_[next] = next_distance;
+          queue[tail++] = next;
+        }
+      };
+      if (row > 0) visit(curr - n_columns_);
+      if (column > 0) visit(curr - 1);
+      if (row < n_rows_ - 1) visit(curr + n_columns_);
+      if (column < n_columns_ - 1) visit(curr + 1);
+    }
+
+    const int start = grid.Find('a');
+    min_steps_ = start < 0 ? kUnreachable : distances_[start];
+  }
+
+  std::shared_ptr<const DistanceField> DistanceField::ForGrid(const std::string& grid) {
+    const size_t hash = std::hash<std::string>()(grid);
+    FieldCache& cache = Cache();
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      auto it = cache.slots.find(hash);
+      if (it != cache.slots.end() && cache.entries[it->second].grid == grid) {
+        cache.entries[it->second].referenced = true;
+        return cache.entries[it->second].field;
+      }
+    }
+
+    //Calcolato fuori dal lock; se due thread chiedono la stessa griglia vale il primo inserito
+    auto field = std::make_shared<const DistanceField>(MazeGrid::FromString(grid));
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    auto it = cache.slots.find(hash);
+    if (it != cache.slots.end()) {
+      CachedField& entry = cache.entries[it->second];
+      if (entry.grid == grid)
+        return entry.field;
+      //Collisione dell'hash: la griglia nuova prende il posto della vecchia
+      entry = CachedField{grid, field, true};
+      return field;
+    }
+    int slot = cache.FreeSlot();
+    cache.entries[slot] = CachedField{grid, field, false};
+    cache.slots[hash] = slot;
+    return field;
+  }
+
+  void DistanceField::ClearCache() {
+    FieldCache& cache = Cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.entries.clear();
+    cache.slots.clear();
+    cache.hand = 0;
+  }
+
+}
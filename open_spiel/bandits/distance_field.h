@@ -0,0 +1,55 @@
+#ifndef DISTANCE_FIELD_H
+#define DISTANCE_FIELD_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "maze_generator.h"
+
+namespace policies {
+
+  // Shortest-path distances to the destination 'A' of a pathfinding grid from
+  // every cell, moving up, down, left and right through non-wall cells,
+  // computed with a single breadth-first search from the destination and
+  // stored in a flat array in the order of MazeGrid::Index.
+  class DistanceField {
+    public :
+      static constexpr int kUnreachable = -1;
+
+      // Fields kept by the cache of ForGrid. Beyond that the least recently
+      // used ones are evicted (clock algorithm, as in AbstractionCache), so
+      // the memory of a sweep over thousands of mazes stays bounded.
+      static constexpr int kCacheCapacity = 64;
+
+      explicit DistanceField(const MazeGrid& grid);
+
+      // Distance field of the grid string, computed on the first request for
+      // that grid and then shared: the last kCacheCapacity fields are cached
+      // by hash of the grid and the cache is safe to use from several threads.
+      static std::shared_ptr<const DistanceField> ForGrid(const std::string& grid);
+
+      // Empties the cache of ForGrid. Fields already handed out stay valid.
+      static void ClearCache();
+
+      int n_rows() const { return n_rows_; }
+      int n_columns() const { return n_columns_; }
+
+      // Steps from the cell to the destination, kUnreachable for walls and
+      // cells cut off from it.
+      int Distance(int row, int column) const { return distances_[row * n_columns_ + column]; }
+      int Distance(int index) const { return distances_[index]; }
+
+      // Fewest steps from the start 'a' to the destination, as returned by BFS.
+      int MinSteps() const { return min_steps_; }
+
+    private :
+      int n_rows_;
+      int n_columns_;
+      int min_steps_;
+      std::vector<int> distances_;
+  };
+
+}
+
+#endif
@@ -8,13 +8,12 @@ using open_spiel::Action;
 using open_spiel::State;
 
 using std::vector;
-using policies::GetOptimalAction;
 
 namespace policies {
 
-  Action EpsilonGreedyPolicy::action_selection (const State& state) {
+  Action EpsilonGreedyPolicy::action_selection (const StepContext& context) {
 
-    vector<Action> legal_actions = state.LegalActions();
+    const vector<Action>& legal_actions = context.legal_actions;
     if (legal_actions.empty()) {
       return open_spiel::kInvalidAction;
     }
@@ -24,20 +23,38 @@ namespace policies {
       return legal_actions[absl::Uniform<int>(rng_, 0, legal_actions.size())];
     }
     // Choose the best action
-    return GetOptimalAction(qtable_pointer, state, abstraction_func);
+    return qtable_pointer->GreedyAction(context.state_id, legal_actions, -1,
+                                        open_spiel::kInvalidAction).action;
   }
 
-  void EpsilonGreedyPolicy::reward_update (const State& state, Action& action, double reward) {
+  void EpsilonGreedyPolicy::action_selection_batch (absl::Span<const StepContext* const> contexts, absl::Span<Action> actions) {
+    for (int i = 0; i < contexts.size(); i++)
+      actions[i] = EpsilonGreedyPolicy::action_selection(*contexts[i]); //Chiamata non virtuale
+  }
+
+  void EpsilonGreedyPolicy::reward_update (const StepContext& context, Action& action, double reward, const StepContext* next_context) {
     //Epsilon Greedy non necessita di alcuna propria struttura da aggiornare, è stateless
   }
 
+  std::unique_ptr<GenericPolicy> EpsilonGreedyPolicy::Clone() const {
+    return std::make_unique<EpsilonGreedyPolicy>(epsilon);
+  }
+
+  void EpsilonGreedyPolicy::SaveState(open_spiel::CheckpointWriter* writer) const {
+    writer->WriteEngine(rng_);
+  }
+
+  void EpsilonGreedyPolicy::LoadState(open_spiel::CheckpointReader* reader) {
+    reader->ReadEngine(&rng_);
+  }
+
   std::string EpsilonGreedyPolicy::toString () const {
     std::stringstream s;
     s << "EpsilonGreedy (" << epsilon << ")";
     return s.str();
   }
 
-  void EpsilonGreedyPolicy::setQTableStructure(absl::flat_hash_map<std::pair<std::string, Action>, double>* table, double disc_factor, double learn_rate, StateAbstractionFunction func) {
+  void EpsilonGreedyPolicy::setQTableStructure(QTable* table, double disc_factor, double learn_rate, StateAbstractionFunction func) {
       qtable_pointer = table;
       abstraction_func = func;
   }
@@ -23,7 +23,7 @@ namespace policies {
     private:
 
       double epsilon;
-      absl::flat_hash_map<std::pair<std::string, Action>, double>* qtable_pointer;
+      QTable* qtable_pointer;
       StateAbstractionFunction abstraction_func;
 
       std::random_device rd;
@@ -39,11 +39,21 @@ namespace policies {
 
       }
 
-      virtual Action action_selection (const State&);
+      virtual std::unique_ptr<GenericPolicy> Clone() const override;
 
-      virtual void reward_update (const State&, Action&, double);
+      virtual void SetSeed(uint32_t seed) override { rng_.seed(seed); }
 
-      virtual void setQTableStructure(absl::flat_hash_map<std::pair<std::string, Action>, double>* table, double disc_factor, double learn_rate, StateAbstractionFunction func) override;
+      virtual Action action_selection (const StepContext&);
+
+      virtual void action_selection_batch (absl::Span<const StepContext* const>, absl::Span<Action>) override;
+
+      virtual void reward_update (const StepContext&, Action&, double, const StepContext*);
+
+      virtual void setQTableStructure(QTable* table, double disc_factor, double learn_rate, StateAbstractionFunction func) override;
+
+      virtual void SaveState(open_spiel::CheckpointWriter* writer) const override;
+
+      virtual void LoadState(open_spiel::CheckpointReader* reader) override;
 
       virtual std::string toString () const override;
 
@@ -0,0 +1,85 @@
+
+#include "exact_evaluation.h"
+
+#include <memory>
+#include <string>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+
+namespace policies {
+
+  namespace {
+
+    class RandomPolicyEvaluation {
+      public :
+        RandomPolicyEvaluation(const TerminalValueFunction& value, int64_t max_states,
+                               const StateKeyFunction& key_func)
+            : value_(value), max_states_(max_states), key_func_(key_func) {}
+
+        // Expected terminal value from state; false if max_states is exceeded.
+        bool Evaluate(const State& state, double* expected_value) {
+          std::string key = Key(state);
+          auto it = values_.find(key);
+          if (it != values_.end()) {
+            *expected_value = it->second;
+            return true;
+          }
+          if (values_.size() >= max_states_)
+            return false;
+
+          double expected = 0;
+          if (state.IsTerminal()) {
+            expected = value_(state);
+          }
+          else if (state.IsChanceNode()) {
+            for (const auto& [outcome, probability] : state.ChanceOutcomes()) {
+              double child_value;
+              if (!Evaluate(*state.Child(outcome), &child_value))
+                return false;
+              expected += probability * child_value;
+            }
+          }
+          else {
+            SPIEL_CHECK_FALSE(state.IsSimultaneousNode()); //Usare la versione turn-based del gioco
+            std::vector<Action> legal_actions = state.LegalActions();
+            for (Action action : legal_actions) {
+              double child_value;
+              if (!Evaluate(*state.Child(action), &child_value))
+                return false;
+              expected += child_value;
+            }
+            expected /= legal_actions.size();
+          }
+
+          values_.emplace(std::move(key), expected);
+          *expected_value = expected;
+          return true;
+        }
+
+      private :
+        std::string Key(const State& state) const {
+          //I ritorni accumulati fanno parte della chiave: il valore finale puo' dipendere da tutto il percorso
+          double partial_return = state.Returns()[0];
+          std::string returns(reinterpret_cast<const char*>(&partial_return), sizeof(partial_return));
+          if (key_func_)
+            return absl::StrCat(key_func_(state), "|", returns);
+          return absl::StrCat(state.ToString(), "|", state.MoveNumber(), "|", returns);
+        }
+
+        const TerminalValueFunction& value_;
+        const int64_t max_states_;
+        const StateKeyFunction& key_func_;
+        absl::flat_hash_map<std::string, double> values_;
+    };
+
+  }
+
+  bool ExactRandomPolicyValue(const Game& game, const TerminalValueFunction& value,
+                              int64_t max_states, double* expected_value,
+                              const StateKeyFunction& key_func) {
+    RandomPolicyEvaluation evaluation(value, max_states, key_func);
+    return evaluation.Evaluate(*game.NewInitialState(), expected_value);
+  }
+
+}
@@ -0,0 +1,40 @@
+#ifndef EXACT_EVALUATION_H
+#define EXACT_EVALUATION_H
+
+#include <cstdint>
+#include <functional>
+
+#include "open_spiel/spiel.h"
+#include "bandits/generic_policy.h"
+
+using open_spiel::Game;
+using open_spiel::State;
+
+namespace policies {
+
+  // Score of a finished match, e.g. 1 for a win and 0 otherwise.
+  typedef std::function<double(const State& terminal)> TerminalValueFunction;
+
+  // Computes exactly the expected terminal value of a match in which every
+  // player picks uniformly random legal actions and chance follows its
+  // outcome probabilities: the expectation the Monte Carlo baseline of the
+  // example estimates, without sampling noise.
+  //
+  // The game tree is evaluated by backward induction, merging the states
+  // with the same key so that each distinct state is evaluated once. The key
+  // of a state is key_func(state), by default its ToString and move number,
+  // together with its current returns; it must determine how the match can
+  // continue and the terminal value (for pathfinding without random moves
+  // the default key is enough). Games whose transitions draw randomness
+  // outside of chance nodes can not be evaluated this way.
+  //
+  // Returns false, leaving expected_value unchanged, if the game has more
+  // than max_states distinct keys: the caller should then fall back to
+  // sampling.
+  bool ExactRandomPolicyValue(const Game& game, const TerminalValueFunction& value,
+                              int64_t max_states, double* expected_value,
+                              const StateKeyFunction& key_func = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+
+#include "experiment_runner.h"
+
+#include <random>
+
+namespace policies {
+
+  uint32_t DeriveSeed(uint32_t base_seed, std::initializer_list<uint32_t> ids) {
+    std::vector<uint32_t> seed_data;
+    seed_data.reserve(ids.size() + 1);
+    seed_data.push_back(base_seed);
+    seed_data.insert(seed_data.end(), ids.begin(), ids.end());
+    std::seed_seq seq(seed_data.begin(), seed_data.end());
+    uint32_t seed;
+    seq.generate(&seed, &seed + 1);
+    return seed;
+  }
+
+  ExperimentRunner::ExperimentRunner(int n_threads, uint32_t base_seed)
+      : base_seed_(base_seed),
+        pool_(std::make_unique<open_spiel::ThreadPool>(n_threads)) {}
+
+  std::vector<ExperimentTask> ExperimentRunner::MakeTasks(int n_reps, int maze_reps, int n_policies) const {
+    std::vector<ExperimentTask> tasks;
+    tasks.reserve(n_reps * maze_reps * n_policies);
+    for (int rep = 0; rep < n_reps; rep++) {
+      for (int m_rep = 0; m_rep < maze_reps; m_rep++) {
+        for (int policy = 0; policy < n_policies; policy++) {
+          tasks.push_back({rep, m_rep, policy, Seed({(uint32_t)rep, (uint32_t)m_rep, (uint32_t)policy})});
+        }
+      }
+    }
+    return tasks;
+  }
+
+  void ExperimentRunner::ParallelFor(int n, const std::function<void(int)>& fn) {
+    pool_->ParallelFor(n, [&fn](int i, int worker) { fn(i); });
+  }
+
+}
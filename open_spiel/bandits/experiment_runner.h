@@ -0,0 +1,59 @@
+#ifndef EXPERIMENT_RUNNER_H
+#define EXPERIMENT_RUNNER_H
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "open_spiel/utils/thread_pool.h"
+
+namespace policies {
+
+  // Scores of a single training run, as (phase, score) pairs.
+  typedef std::vector<std::pair<int, double>> PhaseScores;
+
+  // One independent training run of a sweep.
+  struct ExperimentTask {
+    int rep;          // Repetition index (a new maze for pathfinding)
+    int maze_rep;     // Repetition of the same maze
+    int policy_index; // Index of the policy in the sweep
+    uint32_t seed;    // Seed of every random number stream of the run
+  };
+
+  // Derives the seed of the random number stream identified by ids from
+  // base_seed. The same base seed and ids always give the same seed,
+  // independently of the thread the stream is used on.
+  uint32_t DeriveSeed(uint32_t base_seed, std::initializer_list<uint32_t> ids);
+
+  // Executes the independent runs of a sweep on a pool of worker threads, with
+  // deterministic per-run seeding, so that a sweep gives the same results for
+  // any number of threads.
+  class ExperimentRunner {
+    public :
+      // n_threads <= 0 means one thread per hardware core.
+      ExperimentRunner(int n_threads, uint32_t base_seed);
+
+      int NumThreads() const { return pool_->NumThreads(); }
+      uint32_t base_seed() const { return base_seed_; }
+
+      uint32_t Seed(std::initializer_list<uint32_t> ids) const {
+        return DeriveSeed(base_seed_, ids);
+      }
+
+      // Tasks of a sweep of n_reps * maze_reps * n_policies runs, in the order
+      // a sequential sweep would run them.
+      std::vector<ExperimentTask> MakeTasks(int n_reps, int maze_reps, int n_policies) const;
+
+      // Runs fn(i) for every i in [0, n) concurrently.
+      void ParallelFor(int n, const std::function<void(int)>& fn);
+
+    private :
+      uint32_t base_seed_;
+      std::unique_ptr<open_spiel::ThreadPool> pool_;
+  };
+
+}
+
+#endif
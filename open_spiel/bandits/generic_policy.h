@@ -2,29 +2,103 @@
 #define GENERIC_POLICY_H
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <random>
 
 #include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
 #include "open_spiel/abseil-cpp/absl/random/distributions.h"
 #include "open_spiel/abseil-cpp/absl/random/random.h"
+#include "open_spiel/abseil-cpp/absl/types/span.h"
+#include "open_spiel/algorithms/q_table.h"
 #include "open_spiel/spiel_globals.h"
 #include "open_spiel/spiel_utils.h"
 #include "open_spiel/spiel.h"
+#include "open_spiel/utils/binary_checkpoint.h"
 
 using open_spiel::Action;
 using open_spiel::State;
+using open_spiel::algorithms::QTable;
+using open_spiel::algorithms::QRowBuffer;
+using open_spiel::algorithms::QStateId;
+using open_spiel::algorithms::kInvalidQStateId;
 
 namespace policies {
 
   typedef std::function<std::string(const std::string)> StateAbstractionFunction;
 
+  // Computes the Q-table key of a state directly from the state, without
+  // going through ToString. Used for compact keys of specific games.
+  typedef std::function<std::string(const State&)> StateKeyFunction;
+
+  // The key function equivalent to applying func to the state string.
+  inline StateKeyFunction MakeStateKeyFunction(StateAbstractionFunction func) {
+    return [func](const State& state) { return func(state.ToString()); };
+  }
+
+  // Per-step information about the decision state, computed once by the solver
+  // and shared with the policy, so that neither has to rebuild the state
+  // string, apply the abstraction function or hash the key again.
+  struct StepContext {
+    const State* state = nullptr;
+    std::string key; //abstraction_func(state->ToString())
+    QStateId state_id = kInvalidQStateId; //Id of key in the Q-table the policy is bound to
+    std::vector<Action> legal_actions;
+
+    // state->ToString(), built at most once per step: the solver fills it in
+    // when it builds the key from the string, otherwise it is built on first
+    // use.
+    const std::string& StateString() const {
+      if (!state_string_valid) {
+        state_string = state->ToString();
+        state_string_valid = true;
+      }
+      return state_string;
+    }
+
+    mutable std::string state_string;
+    mutable bool state_string_valid = false;
+  };
+
   class GenericPolicy {
     public :
-      virtual Action action_selection (const State& state) = 0;
+      virtual ~GenericPolicy() = default;
+
+      // Returns a new policy with the same parameters and no learned state.
+      // A policy keeps per-solver state (the bound Q-table and its own
+      // statistics), so every solver that may run concurrently with others
+      // needs its own instance.
+      virtual std::unique_ptr<GenericPolicy> Clone() const = 0;
+
+      // Reseeds the random number generator of the policy, if it has one.
+      virtual void SetSeed(uint32_t seed) {}
+
+      virtual Action action_selection (const StepContext& context) = 0;
+
+      // Selects an action for every context, as calling action_selection on
+      // each of them in order would. Used by the batched training loop;
+      // policies override it to pay a single virtual call per batch.
+      virtual void action_selection_batch (absl::Span<const StepContext* const> contexts, absl::Span<Action> actions) {
+        for (int i = 0; i < contexts.size(); i++)
+          actions[i] = action_selection(*contexts[i]);
+      }
+
+      // next_context is the context of the state the solver actually reached
+      // after applying action (chance outcomes included), or nullptr if that
+      // state is terminal. Policies must not simulate the transition again.
+      virtual void reward_update (const StepContext& context, Action& action, double reward, const StepContext* next_context) = 0;
+
+      virtual void setQTableStructure(QTable* table, double disc_factor, double learn_rate, policies::StateAbstractionFunction func) {};
 
-      virtual void reward_update (const State& state, Action& action, double reward) = 0;
+      // Write and restore what the policy learned (its statistics) and the
+      // state of its generator, for TabularQLearningSolver::Save. The Q-table
+      // the policy is bound to is saved by the solver.
+      virtual void SaveState(open_spiel::CheckpointWriter* writer) const {}
+      virtual void LoadState(open_spiel::CheckpointReader* reader) {}
 
-      virtual void setQTableStructure(absl::flat_hash_map<std::pair<std::string, Action>, double>* table, double disc_factor, double learn_rate, policies::StateAbstractionFunction func) {};
+      // Approximate heap memory of the statistics of the policy, for
+      // TabularQLearningSolver::GetStats.
+      virtual size_t MemoryUsage() const { return 0; }
 
       virtual std::string toString () const = 0;
       
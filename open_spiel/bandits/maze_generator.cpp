@@ -0,0 +1,196 @@
+
+#include "maze_generator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "open_spiel/abseil-cpp/absl/random/distributions.h"
+#include "open_spiel/spiel_utils.h"
+#include "open_spiel/utils/thread_pool.h"
+#include "experiment_runner.h"
+
+namespace policies {
+
+  namespace {
+
+    // Neighbours of cell index in grid that are not walls, written to
+    // neighbours; returns how many there are.
+    int OpenNeighbours(const MazeGrid& grid, int index, int neighbours[4]) {
+      int n = 0;
+      int row = index / grid.n_columns();
+      int column = index % grid.n_columns();
+      if (row > 0 && grid.At(index - grid.n_columns()) != '*')
+        neighbours[n++] = index - grid.n_columns();
+      if (column > 0 && grid.At(index - 1) != '*')
+        neighbours[n++] = index - 1;
+      if (row < grid.n_rows() - 1 && grid.At(index + grid.n_columns()) != '*')
+        neighbours[n++] = index + grid.n_columns();
+      if (column < grid.n_columns() - 1 && grid.At(index + 1) != '*')
+        neighbours[n++] = index + 1;
+      return n;
+    }
+
+    // Flood fill from source, stopping early when target (if not -1) is found.
+    std::vector<char> FloodFill(const MazeGrid& grid, int source, int target) {
+      std::vector<char> reached(grid.NumCells(), 0);
+      std::vector<int> stack = {source};
+      reached[source] = 1;
+      int neighbours[4];
+      while (!stack.empty()) {
+        int curr = stack.back();
+        stack.pop_back();
+        if (curr == target)
+          break;
+        int n = OpenNeighbours(grid, curr, neighbours);
+        for (int i = 0; i < n; i++) {
+          if (!reached[neighbours[i]]) {
+            reached[neighbours[i]] = 1;
+            stack.push_back(neighbours[i]);
+          }
+        }
+      }
+      return reached;
+    }
+
+  }
+
+  MazeGrid::MazeGrid(int n_rows, int n_columns, char fill)
+      : n_rows_(n_rows), n_columns_(n_columns), cells_(n_rows * n_columns, fill) {
+    SPIEL_CHECK_GT(n_rows, 0);
+    SPIEL_CHECK_GT(n_columns, 0);
+  }
+
+  MazeGrid MazeGrid::FromString(const std::string& grid) {
+    SPIEL_CHECK_FALSE(grid.empty());
+    const int n_columns = grid.find('\n') == std::string::npos ? grid.size() : grid.find('\n');
+    const int n_rows = (grid.size() + (grid.back() == '\n' ? 0 : 1)) / (n_columns + 1);
+    MazeGrid maze(n_rows, n_columns);
+    for (int row = 0; row < n_rows; row++) {
+      const int offset = row * (n_columns + 1);
+      //Tutte le righe devono avere la stessa lunghezza
+      SPIEL_CHECK_TRUE(offset + n_columns == grid.size() || grid[offset + n_columns] == '\n');
+      maze.cells_.replace(row * n_columns, n_columns, grid, offset, n_columns);
+    }
+    SPIEL_CHECK_EQ(n_rows * (n_columns + 1) - (grid.back() == '\n' ? 0 : 1), grid.size());
+    return maze;
+  }
+
+  int MazeGrid::Find(char c) const {
+    size_t index = cells_.find(c);
+    return index == std::string::npos ? -1 : index;
+  }
+
+  std::string MazeGrid::ToString() const {
+    std::string ret;
+    ret.reserve(n_rows_ * (n_columns_ + 1));
+    for (int row = 0; row < n_rows_; row++) {
+      ret.append(cells_, row * n_columns_, n_columns_);
+      ret += '\n';
+    }
+    return ret;
+  }
+
+  std::vector<char> ReachableCells(const MazeGrid& grid, int source) {
+    return FloodFill(grid, source, -1);
+  }
+
+  bool IsReachable(const MazeGrid& grid, int source, int target) {
+    return FloodFill(grid, source, target)[target];
+  }
+
+  MazeGenerator RandomWallsGenerator(double wall_ratio) {
+    return [wall_ratio](int n_rows, int n_columns, std::mt19937& rng_) {
+      MazeGrid maze(n_rows, n_columns);
+      //Stesso numero di muri di maze_gen, devono restare liberi partenza e obiettivo
+      const int n_walls = std::ceil(n_rows * n_columns * wall_ratio);
+      SPIEL_CHECK_LE(n_walls, n_rows * n_columns - 2);
+
+      const int source = maze.Index(0, 0);
+      const int target = maze.Index(n_rows - 1, n_columns - 1);
+      do {
+        maze = MazeGrid(n_rows, n_columns);
+        maze.At(source) = 'a';
+        maze.At(target) = 'A';
+        for (int i = 0; i < n_walls; i++) {
+          int wall_x;
+          int wall_y;
+          do {
+            wall_x = absl::Uniform<int>(rng_, 0, n_rows);
+            wall_y = absl::Uniform<int>(rng_, 0, n_columns);
+          } while (maze.At(wall_x, wall_y) != '.');
+          maze.At(wall_x, wall_y) = '*';
+        }
+      } while (!IsReachable(maze, source, target));
+      return maze;
+    };
+  }
+
+  MazeGenerator BacktrackerGenerator(double extra_openings) {
+    SPIEL_CHECK_GE(extra_openings, 0);
+    SPIEL_CHECK_LE(extra_openings, 1);
+    return [extra_openings](int n_rows, int n_columns, std::mt19937& rng_) {
+      MazeGrid maze(n_rows, n_columns, '*');
+
+      //Visita in profondita' randomizzata sulle celle a coordinate pari, abbattendo il muro tra una cella e la successiva
+      static constexpr int kDirections[4][2] = {{-2, 0}, {0, -2}, {2, 0}, {0, 2}};
+      std::vector<std::pair<int, int>> stack = {{0, 0}};
+      maze.At(0, 0) = '.';
+      while (!stack.empty()) {
+        auto [row, column] = stack.back();
+        std::pair<int, int> candidates[4];
+        int n_candidates = 0;
+        for (auto& direction : kDirections) {
+          int next_row = row + direction[0];
+          int next_column = column + direction[1];
+          if (next_row >= 0 && next_row < n_rows && next_column >= 0 && next_column < n_columns &&
+              maze.At(next_row, next_column) == '*')
+            candidates[n_candidates++] = {next_row, next_column};
+        }
+        if (n_candidates == 0) {
+          stack.pop_back();
+          continue;
+        }
+        auto [next_row, next_column] = candidates[absl::Uniform<int>(rng_, 0, n_candidates)];
+        maze.At((row + next_row) / 2, (column + next_column) / 2) = '.';
+        maze.At(next_row, next_column) = '.';
+        stack.push_back({next_row, next_column});
+      }
+
+      if (extra_openings > 0) {
+        for (int i = 0; i < maze.NumCells(); i++) {
+          if (maze.At(i) == '*' && absl::Uniform(rng_, 0.0, 1.0) < extra_openings)
+            maze.At(i) = '.';
+        }
+      }
+
+      //Con dimensioni pari l'angolo in basso a destra non e' una cella della visita: lo colleghiamo risalendo fino a una cella pari
+      const std::vector<char> reached = ReachableCells(maze, 0);
+      int row = n_rows - 1;
+      int column = n_columns - 1;
+      while (!reached[maze.Index(row, column)]) {
+        maze.At(row, column) = '.';
+        if (row % 2 == 1)
+          row--;
+        else
+          column--;
+      }
+
+      maze.At(0, 0) = 'a';
+      maze.At(n_rows - 1, n_columns - 1) = 'A';
+      return maze;
+    };
+  }
+
+  std::vector<std::string> GenerateMazes(int n_mazes, int n_rows, int n_columns,
+                                         const MazeGenerator& generator,
+                                         uint32_t base_seed, int n_threads) {
+    std::vector<std::string> mazes(n_mazes);
+    open_spiel::ThreadPool pool(std::min(n_threads, n_mazes));
+    pool.ParallelFor(n_mazes, [&](int i, int worker) {
+      std::mt19937 rng_(DeriveSeed(base_seed, {(uint32_t)i}));
+      mazes[i] = generator(n_rows, n_columns, rng_).ToString();
+    });
+    return mazes;
+  }
+
+}
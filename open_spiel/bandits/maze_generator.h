@@ -0,0 +1,79 @@
+#ifndef MAZE_GENERATOR_H
+#define MAZE_GENERATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace policies {
+
+  // A pathfinding grid stored in a single flat buffer in row-major order, with
+  // the characters of the pathfinding game: '.' empty, '*' wall, 'a' start and
+  // 'A' destination.
+  class MazeGrid {
+    public :
+      MazeGrid(int n_rows, int n_columns, char fill = '.');
+
+      // Parses a grid string as given to the "grid" parameter of pathfinding:
+      // rows separated by '\n', all of the same length, the last '\n' optional.
+      static MazeGrid FromString(const std::string& grid);
+
+      int n_rows() const { return n_rows_; }
+      int n_columns() const { return n_columns_; }
+      int NumCells() const { return cells_.size(); }
+
+      int Index(int row, int column) const { return row * n_columns_ + column; }
+      // Index of the first cell holding c, -1 if there is none.
+      int Find(char c) const;
+      char At(int row, int column) const { return cells_[Index(row, column)]; }
+      char& At(int row, int column) { return cells_[Index(row, column)]; }
+      char At(int index) const { return cells_[index]; }
+      char& At(int index) { return cells_[index]; }
+
+      // Grid string accepted by the "grid" parameter of pathfinding, one row
+      // per line.
+      std::string ToString() const;
+
+    private :
+      int n_rows_;
+      int n_columns_;
+      std::string cells_;
+  };
+
+  // Returns, for every cell, whether it can be reached from the cell source
+  // (an index of grid) moving up, down, left and right through non-wall
+  // cells. Iterative flood fill, linear in the number of cells.
+  std::vector<char> ReachableCells(const MazeGrid& grid, int source);
+
+  // Whether target can be reached from source, stopping as soon as it is.
+  bool IsReachable(const MazeGrid& grid, int source, int target);
+
+  // Builds a grid of n_rows x n_columns with the start in the top-left corner
+  // and the destination in the bottom-right one, reachable from the start,
+  // drawing all its randomness from rng.
+  typedef std::function<MazeGrid(int n_rows, int n_columns, std::mt19937& rng)> MazeGenerator;
+
+  // Walls on wall_ratio of the cells at uniformly random positions, redrawn
+  // until the destination is reachable. Gives the same mazes as maze_gen for
+  // the same generator state.
+  MazeGenerator RandomWallsGenerator(double wall_ratio);
+
+  // Perfect maze carved by a randomized depth-first search (recursive
+  // backtracker, with an explicit stack) over the cells with even
+  // coordinates: every open cell is reachable and corridors are one cell
+  // wide. Each remaining wall is then removed with probability
+  // extra_openings, which adds loops.
+  MazeGenerator BacktrackerGenerator(double extra_openings = 0);
+
+  // Generates n_mazes grid strings in parallel on n_threads threads (<= 0 means
+  // one per core). Maze i only depends on base_seed and i, so the batch is the
+  // same for any number of threads.
+  std::vector<std::string> GenerateMazes(int n_mazes, int n_rows, int n_columns,
+                                         const MazeGenerator& generator,
+                                         uint32_t base_seed, int n_threads = 0);
+
+}
+
+#endif
@@ -3,10 +3,12 @@
 #include <random>
 
 #include "pathfinding_helper.h"
+#include "maze_generator.h"
+#include "distance_field.h"
 
 namespace policies {
 
-std::vector<std::pair<int, int>> possible_next_positions(std::vector<std::vector<char>> maze, std::pair<int, int> curr) {
+std::vector<std::pair<int, int>> possible_next_positions(const std::vector<std::vector<char>>& maze, std::pair<int, int> curr) {
   std::vector<std::pair<int, int>> ret;
   int x = curr.first;
   int y = curr.second;
@@ -22,21 +24,26 @@ std::vector<std::pair<int, int>> possible_next_positions(std::vector<std::vector
   return ret;
 }
 
-bool DFS (std::vector<std::vector<char>> maze, std::vector<std::vector<char>>* colors_p, std::pair<int, int> curr) {
+bool DFS (const std::vector<std::vector<char>>& maze, std::vector<std::vector<char>>* colors_p, std::pair<int, int> curr) {
+  //Pila esplicita: la ricorsione esauriva lo stack sui labirinti grandi
+  std::vector<std::pair<int, int>> stack = {curr};
   (*colors_p)[curr.first][curr.second] = 'n';
-  if (maze[curr.first][curr.second] == 'A') //Target del labirinto
-    return true;
-  else {
-    bool ret = false;
+  while (!stack.empty()) {
+    curr = stack.back();
+    stack.pop_back();
+    if (maze[curr.first][curr.second] == 'A') //Target del labirinto
+      return true;
     for (auto& [next_x, next_y] : possible_next_positions(maze, curr)) {
-      if ((*colors_p)[next_x][next_y] == 'b')
-        ret = ret || DFS(maze, colors_p, {next_x, next_y});
+      if ((*colors_p)[next_x][next_y] == 'b') {
+        (*colors_p)[next_x][next_y] = 'n';
+        stack.push_back({next_x, next_y});
+      }
     }
-    return ret;
   }
+  return false;
 }
 
-std::string maze_to_string(std::vector<std::vector<char>> maze) {
+std::string maze_to_string(const std::vector<std::vector<char>>& maze) {
   std::string ret = "";
   for (int i = 0; i < maze.size(); i++) {
     for (int j = 0; j < maze[i].size(); j++) {
@@ -47,7 +54,7 @@ std::string maze_to_string(std::vector<std::vector<char>> maze) {
   return ret;
 }
 
-bool traversable_maze_check(std::vector<std::vector<char>> maze, std::pair<int, int> source) {
+bool traversable_maze_check(const std::vector<std::vector<char>>& maze, std::pair<int, int> source) {
   std::vector<std::vector<char>> colors;
   colors.resize(maze.size());
   for (int i = 0; i < maze.size(); i++) {
@@ -65,46 +72,13 @@ std::string maze_gen (int n_rows , int n_columns, double wall_ratio) {
   std::random_device rd;
   std::mt19937 rng_(rd());
 
-  std::vector<std::vector<char>> maze;
-  int source_x;
-  int source_y;
-
-  maze.resize(n_rows);
-
-  do {
-
-    for (int i = 0; i < n_rows; i++) { //Riempiamo di spazi vuoti il labirinto
-      maze[i].resize(n_columns);
-      for (int j = 0; j < n_columns; j++) {
-        maze[i][j] = '.';
-      }
-    }
-
-    source_x = 0; //Scegliamo la posizione iniziale
-    source_y = 0;
-    maze[source_x][source_y] = 'a';
-
-    int target_x = n_rows-1; //Scegliamo la posizione dell'obiettivo
-    int target_y = n_columns-1;
-    maze[target_x][target_y] = 'A';
-
+  return maze_gen(n_rows, n_columns, wall_ratio, rng_);
 
-    for (int i = 0; i < n_rows*n_columns*wall_ratio; i++) {
-      int wall_x;
-      int wall_y;
-
-      do {
-        wall_x = absl::Uniform<int>(rng_, 0, n_rows);
-        wall_y = absl::Uniform<int>(rng_, 0, n_columns);
-      } while (maze[wall_x][wall_y] != '.'); //Il muro è in una posizione giusta solo se sostituisce uno spazio vuoto DA CAMBIARE
-
-      maze[wall_x][wall_y] = '*';
-    }
-
-  } while (!traversable_maze_check(maze, {source_x, source_y})); //Passiamo l'origine della dfs per scoprire se il target è raggiungibile
+}
 
+std::string maze_gen (int n_rows , int n_columns, double wall_ratio, std::mt19937& rng_) {
 
-  return (maze_to_string(maze));
+  return RandomWallsGenerator(wall_ratio)(n_rows, n_columns, rng_).ToString();
 
 }
 
@@ -139,43 +113,8 @@ std::vector<std::vector<char>> parseStringGrid(std::string grid_str, std::pair<i
 }
 
 int BFS (std::string maze) {
-  std::pair<int, int> starting_position;
-  std::pair<int, int> destination;
-  std::vector<std::vector<char>> grid_vec = parseStringGrid(maze, starting_position, destination);
-  int n_rows = grid_vec.size();
-  int n_columns = grid_vec[0].size();
-  char color [n_rows][n_columns];
-  int dist [n_rows][n_columns];
-  for (int i = 0; i < n_rows; i++) {
-    for (int j = 0; j < n_columns; j++) {
-      color[i][j] = 'b';
-      dist[i][j] = -1;
-    }
-  }
-  std::queue<std::pair<int, int>> pos_queue;
-  std::pair<int, int> curr_pos;
-  pos_queue.push(starting_position);
-  color[starting_position.first][starting_position.second] = 'g';
-  dist[starting_position.first][starting_position.second] = 0;
-
-  while (!pos_queue.empty()) {
-
-    curr_pos = pos_queue.front();
-    pos_queue.pop();
-    for (auto& [x,y] : possible_next_positions(grid_vec, curr_pos)) {
-      if (color[x][y] == 'b') {
-        pos_queue.push({x,y});
-        color[x][y] = 'g';
-        dist[x][y] = dist[curr_pos.first][curr_pos.second]+1;
-      }
-    }
-
-    color[curr_pos.first][curr_pos.second] = 'n';
-
-  }
-
-  return dist[destination.first][destination.second];
-  
+  //Il campo delle distanze viene calcolato una sola volta per griglia
+  return DistanceField::ForGrid(maze)->MinSteps();
 }
 
-}
\ No newline at end of file
+}
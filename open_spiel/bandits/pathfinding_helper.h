@@ -15,19 +15,21 @@
 
 namespace policies {
 
-  std::vector<std::pair<int, int>> possible_next_positions(std::vector<std::vector<char>> maze, std::pair<int, int> curr);
+  std::vector<std::pair<int, int>> possible_next_positions(const std::vector<std::vector<char>>& maze, std::pair<int, int> curr);
 
-  bool DFS (std::vector<std::vector<char>> maze, std::vector<std::vector<char>>* colors_p, std::pair<int, int> curr);
+  bool DFS (const std::vector<std::vector<char>>& maze, std::vector<std::vector<char>>* colors_p, std::pair<int, int> curr); //Visita iterativa
 
-  std::string maze_to_string(std::vector<std::vector<char>> maze);
+  std::string maze_to_string(const std::vector<std::vector<char>>& maze);
 
-  bool traversable_maze_check(std::vector<std::vector<char>> maze, std::pair<int, int> source);
+  bool traversable_maze_check(const std::vector<std::vector<char>>& maze, std::pair<int, int> source);
 
   std::string maze_gen (int n_rows = 5, int n_columns = 5, double wall_ratio = 0.2);
 
+  std::string maze_gen (int n_rows, int n_columns, double wall_ratio, std::mt19937& rng_); //Come sopra, con un generatore fornito dal chiamante (riproducibile). Vedi maze_generator.h per altri generatori e per la generazione in blocco
+
   std::vector<std::vector<char>> parseStringGrid(std::string grid_str);
 
-  int BFS (std::string maze);
+  int BFS (std::string maze); //Passi minimi da 'a' ad 'A', dalla cache di DistanceField
 }
 
 #endif
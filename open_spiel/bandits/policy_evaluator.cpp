@@ -0,0 +1,73 @@
+
+#include "policy_evaluator.h"
+
+#include <algorithm>
+#include <random>
+
+#include "open_spiel/abseil-cpp/absl/random/distributions.h"
+#include "experiment_runner.h"
+
+namespace policies {
+
+  namespace {
+
+    // Partite consecutive che condividono uno stream casuale
+    constexpr int kMatchesPerShard = 16;
+    // Stati iniziali creati alla volta, per non tenerli tutti in memoria
+    constexpr int kMatchesPerBatch = 64 * kMatchesPerShard;
+
+  }
+
+  PolicyEvaluator::PolicyEvaluator(int n_threads)
+      : pool_(std::make_unique<open_spiel::ThreadPool>(n_threads)) {}
+
+  EvaluationResult PolicyEvaluator::Evaluate(const Game& game, const EvaluatedPolicy& policy,
+                                             int n_matches, uint32_t seed) {
+    EvaluationResult result;
+    result.returns.resize(n_matches);
+    std::vector<int> lengths(n_matches);
+
+    std::vector<std::unique_ptr<State>> states;
+    for (int batch_start = 0; batch_start < n_matches; batch_start += kMatchesPerBatch) {
+      const int batch_end = std::min(n_matches, batch_start + kMatchesPerBatch);
+      states.clear();
+      for (int match = batch_start; match < batch_end; match++)
+        states.push_back(game.NewInitialState());
+
+      const int n_shards = (batch_end - batch_start + kMatchesPerShard - 1) / kMatchesPerShard;
+      pool_->ParallelFor(n_shards, [&](int shard, int worker) {
+        const int shard_start = batch_start + shard * kMatchesPerShard;
+        const int shard_end = std::min(batch_end, shard_start + kMatchesPerShard);
+        std::mt19937 rng_(DeriveSeed(seed, {(uint32_t)(shard_start / kMatchesPerShard)}));
+
+        for (int match = shard_start; match < shard_end; match++) {
+          State* state = states[match - batch_start].get();
+          int length = 0;
+          while (!state->IsTerminal()) {
+            Action action;
+            if (state->CurrentPlayer() == 0 && policy) {
+              action = policy(*state);
+            }
+            else {
+              std::vector<Action> legal_actions = state->LegalActions();
+              action = legal_actions[absl::Uniform<int>(rng_, 0, legal_actions.size())];
+            }
+            state->ApplyAction(action);
+            length++;
+          }
+          result.returns[match] = state->Returns()[0];
+          lengths[match] = length;
+          states[match - batch_start].reset();
+        }
+      });
+    }
+
+    //Riassunti calcolati in ordine di partita, identici per qualsiasi numero di thread
+    for (int match = 0; match < n_matches; match++) {
+      result.return_stats.Add(result.returns[match]);
+      result.length_stats.Add(lengths[match]);
+    }
+    return result;
+  }
+
+}
@@ -0,0 +1,57 @@
+#ifndef POLICY_EVALUATOR_H
+#define POLICY_EVALUATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "open_spiel/spiel.h"
+#include "open_spiel/utils/thread_pool.h"
+#include "bandits/running_stats.h"
+
+using open_spiel::Action;
+using open_spiel::Game;
+using open_spiel::State;
+
+namespace policies {
+
+  // Action of player 0 in a state, e.g. a FrozenGreedyPolicy. Must be safe to
+  // call from several threads at once.
+  typedef std::function<Action(const State& state)> EvaluatedPolicy;
+
+  // Outcome of a batch of evaluation matches.
+  struct EvaluationResult {
+    std::vector<double> returns; // Return of player 0 in every match, in match order
+    RunningStats return_stats;   // Summary of returns
+    RunningStats length_stats;   // Actions applied in every match, chance outcomes included
+  };
+
+  // Plays independent evaluation matches in parallel: player 0 follows the
+  // evaluated policy, every other player and chance pick uniformly random
+  // legal actions, as in the sequential evaluation of the example.
+  //
+  // Matches are split into fixed shards of consecutive matches, each with its
+  // own random stream derived from the seed, and initial states are created
+  // in match order on the calling thread (games such as pathfinding seed
+  // every new state from a generator of the game). The result therefore only
+  // depends on the seed, not on the number of threads.
+  class PolicyEvaluator {
+    public :
+      // n_threads <= 0 means one thread per hardware core.
+      explicit PolicyEvaluator(int n_threads);
+
+      int NumThreads() const { return pool_->NumThreads(); }
+
+      // Plays n_matches matches of game; an empty policy plays player 0 at
+      // random too, which gives the random baseline.
+      EvaluationResult Evaluate(const Game& game, const EvaluatedPolicy& policy,
+                                int n_matches, uint32_t seed);
+
+    private :
+      std::unique_ptr<open_spiel::ThreadPool> pool_;
+  };
+
+}
+
+#endif
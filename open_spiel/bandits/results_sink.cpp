@@ -0,0 +1,285 @@
+#include "results_sink.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/abseil-cpp/absl/strings/numbers.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_format.h"
+#include "open_spiel/spiel_utils.h"
+#include "utils.h"
+
+namespace policies {
+
+  namespace {
+
+    constexpr char kHeader[] = "kind,policy,rep,maze_rep,phase,value,label";
+
+    // Identifies a record: kind, policy, rep, maze_rep, phase.
+    typedef std::tuple<std::string, int, int, int, int> RecordKey;
+
+    // Label as a CSV field, quoted if it contains separators or quotes.
+    std::string QuoteField(const std::string& field) {
+      if (field.find_first_of(",\"\n") == std::string::npos)
+        return field;
+      std::string quoted = "\"";
+      for (char c : field) {
+        if (c == '"')
+          quoted += '"';
+        quoted += c;
+      }
+      return quoted + "\"";
+    }
+
+    std::string UnquoteField(const std::string& field) {
+      if (field.empty() || field[0] != '"')
+        return field;
+      std::string unquoted;
+      for (int i = 1; i + 1 < field.size(); i++) {
+        if (field[i] == '"')
+          i++; //Virgolette raddoppiate
+        unquoted += field[i];
+      }
+      return unquoted;
+    }
+
+    // Integer column, -1 if empty (the inverse of FormatIndex).
+    int ParseIndex(const std::string& field) {
+      int value = -1;
+      if (!field.empty())
+        SPIEL_CHECK_TRUE(absl::SimpleAtoi(field, &value));
+      return value;
+    }
+
+    // Integer column, empty if value is -1 (or any other negative value).
+    std::string FormatIndex(int value) {
+      return value < 0 ? "" : absl::StrCat(value);
+    }
+
+  }
+
+  ResultsSink::ResultsSink(const std::string& path, bool append) : path_(path) {
+    bool write_header = true;
+    if (append) {
+      std::ifstream existing(path);
+      std::string header;
+      if (std::getline(existing, header)) {
+        if (header != kHeader)
+          open_spiel::SpielFatalError(absl::StrCat("Not a results file: ", path));
+        write_header = false;
+      }
+    }
+    file_.open(path, append ? std::ios::app : std::ios::trunc);
+    if (!file_)
+      open_spiel::SpielFatalError(absl::StrCat("Can not open results file ", path));
+    if (write_header)
+      Append(kHeader);
+  }
+
+  void ResultsSink::RecordPolicy(int policy_index, const std::string& name) {
+    Append(absl::StrCat("policy,", FormatIndex(policy_index), ",,,,,", QuoteField(name)));
+  }
+
+  void ResultsSink::RecordScore(const ExperimentTask& task, int phase, double score) {
+    Append(absl::StrCat("score,", FormatIndex(task.policy_index), ",", FormatIndex(task.rep), ",",
+                        FormatIndex(task.maze_rep), ",", FormatIndex(phase), ",",
+                        absl::StrFormat("%.17g", score), ","));
+  }
+
+  void ResultsSink::RecordBaseline(int rep, double score) {
+    Append(absl::StrCat("baseline,,", FormatIndex(rep), ",,,", absl::StrFormat("%.17g", score), ","));
+  }
+
+  void ResultsSink::Append(const std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ << line << '\n';
+    file_.flush(); //Una riga alla volta: dopo un crash il file contiene tutto cio' che e' stato registrato
+  }
+
+  ResultsSummary SummarizeResults(const std::string& path) {
+    std::ifstream file(path);
+    if (!file)
+      open_spiel::SpielFatalError(absl::StrCat("Can not open results file ", path));
+    std::string line;
+    if (!std::getline(file, line) || line != kHeader)
+      open_spiel::SpielFatalError(absl::StrCat("Not a results file: ", path));
+
+    //L'ultimo record con la stessa chiave sostituisce i precedenti
+    absl::flat_hash_map<RecordKey, double> values;
+    absl::flat_hash_map<int, std::string> names;
+    while (std::getline(file, line)) {
+      if (file.eof())
+        break; //Riga non terminata, interrotta da un crash
+      std::vector<std::string> fields;
+      size_t begin = 0;
+      for (int i = 0; i < 6; i++) {
+        size_t end = line.find(',', begin);
+        SPIEL_CHECK_NE(end, std::string::npos);
+        fields.push_back(line.substr(begin, end - begin));
+        begin = end + 1;
+      }
+      fields.push_back(UnquoteField(line.substr(begin))); //L'etichetta puo' contenere virgole
+
+      const int policy = ParseIndex(fields[1]);
+      if (fields[0] == "policy") {
+        names[policy] = fields[6];
+        continue;
+      }
+      double value;
+      SPIEL_CHECK_TRUE(absl::SimpleAtod(fields[5], &value));
+      values[{fields[0], policy, ParseIndex(fields[2]), ParseIndex(fields[3]), ParseIndex(fields[4])}] = value;
+    }
+
+    //Ordiniamo per politica, fase e ripetizione: le medie sono calcolate come se il test fosse stato sequenziale
+    std::vector<std::pair<RecordKey, double>> records(values.begin(), values.end());
+    std::sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+      const auto& [kind_a, policy_a, rep_a, maze_rep_a, phase_a] = a.first;
+      const auto& [kind_b, policy_b, rep_b, maze_rep_b, phase_b] = b.first;
+      return std::tie(kind_a, policy_a, phase_a, rep_a, maze_rep_a) <
+             std::tie(kind_b, policy_b, phase_b, rep_b, maze_rep_b);
+    });
+
+    ResultsSummary summary;
+    for (const auto& [index, name] : names) {
+      if (index >= summary.policy_names.size())
+        summary.policy_names.resize(index + 1);
+      summary.policy_names[index] = name;
+    }
+    summary.phases.resize(summary.policy_names.size());
+
+    std::vector<double> baseline_scores;
+    std::vector<double> phase_scores;
+    for (int i = 0; i < records.size(); i++) {
+      const auto& [kind, policy, rep, maze_rep, phase] = records[i].first;
+      if (kind == "baseline") {
+        baseline_scores.push_back(records[i].second);
+        continue;
+      }
+      SPIEL_CHECK_LT(policy, summary.phases.size());
+      phase_scores.push_back(records[i].second);
+      const bool last_of_phase = i + 1 == records.size() ||
+                                 std::get<0>(records[i + 1].first) != kind ||
+                                 std::get<1>(records[i + 1].first) != policy ||
+                                 std::get<4>(records[i + 1].first) != phase;
+      if (last_of_phase) {
+        double avg = average_of(phase_scores);
+        summary.phases[policy].push_back({phase, (int)phase_scores.size(), avg,
+                                          standard_deviation_calc(phase_scores, avg)});
+        summary.n_phases = std::max(summary.n_phases, phase);
+        phase_scores.clear();
+      }
+    }
+    summary.baseline = average_of(baseline_scores);
+    return summary;
+  }
+
+  void WriteGnuplotScript(const ResultsSummary& summary, const PlotOptions& options, const std::string& path) {
+    const int n_policies = summary.policy_names.size();
+    const double baseline_value = summary.baseline;
+
+    double max_y = baseline_value;
+    double min_y = baseline_value;
+    bool first = true;
+    for (int algo = 0; algo < n_policies; algo++) {
+      for (const ResultsSummary::PhaseSummary& phase : summary.phases[algo]) {
+        if (first) {
+          max_y = min_y = phase.mean;
+          first = false;
+        }
+        else if (phase.mean-phase.st_dev < min_y) {
+          min_y = phase.mean-phase.st_dev;
+        }
+        else if (phase.mean+phase.st_dev > max_y) {
+          max_y = phase.mean+phase.st_dev;
+        }
+      }
+    }
+
+    if (baseline_value < min_y)
+      min_y = baseline_value;
+    else if (baseline_value > max_y)
+      max_y = baseline_value;
+
+    std::ofstream file_dati(path);
+    if (!file_dati)
+      open_spiel::SpielFatalError(absl::StrCat("Can not write ", path));
+
+    const double max_x = summary.n_phases+n_policies*0.04+0.1;
+
+    file_dati << "set terminal pngcairo size 1800,900\n";
+    file_dati << "set output '"<< options.output << "'\n";
+    file_dati << "set title '"<< options.title <<"'\n";
+    file_dati << "set xlabel 'fase'\n";
+    file_dati << "set ylabel '"<< options.ylabel <<"'\n";
+    file_dati << "set datafile separator ' '\n";
+
+    file_dati << "set xrange [" << 1 << ":" << max_x << "]\n";
+    file_dati << "set yrange [" << min_y-0.05 << ":" << max_y+0.05 << "]\n";
+    file_dati << "set xtics 1\n";
+    file_dati << "set ytics 0.1\n";
+
+    file_dati << "set key outside\n";
+
+    file_dati << "set grid\n";
+    file_dati << "set arrow from 1,"<< baseline_value <<" to "<< max_x <<","<< baseline_value <<" nohead lt 2 lc 'black' dt 2\n"; //La baseline essendo una linea orizzontale possiamo mapparla con una arrow
+    file_dati << "set palette model HSV defined ( 0 0 1 1, 1 1 1 1 ) \n";
+
+    file_dati << "plot ";
+
+    double dt;
+    double pt;
+    double n_eps = 0;
+    double n_vbr = 0;
+    double n_thompson = 0;
+    double i_eps = -1;
+    double i_vbr = -1;
+    double i_thompson = -1;
+    double palette_frac_value = 0.0;
+
+    for (const std::string& name : summary.policy_names) {
+      if (name.find("Epsilon") != std::string::npos) {
+        n_eps++;
+      } else if (name.find("Thompson") != std::string::npos) {
+        n_thompson++;
+      }
+      else  {
+        n_vbr++;
+      }
+    }
+
+    for (const std::string& name : summary.policy_names) {
+      if (name.find("Epsilon") != std::string::npos) {
+        dt = 2;
+        pt = 20;
+        i_eps++;
+        palette_frac_value = i_eps/n_eps;
+      } else if (name.find("Thompson") != std::string::npos) {
+        dt = 3;
+        i_thompson++;
+        palette_frac_value = i_thompson/n_thompson;
+        pt = 9;
+      }
+      else  {
+        dt = 1;
+        pt = 7;
+        i_vbr++;
+        palette_frac_value = i_vbr/n_vbr;
+      }
+
+      file_dati << "'-' with yerrorlines title '" + name + "' lt 1 lc palette frac "<< palette_frac_value <<" dt "<<dt<<" pt "<<pt<<", ";
+    }
+
+    file_dati << "1/0 t 'Baseline (random)' lt 2 lc 'black' dt 2\n"; //Creiamo una linea fittizia (1/0 non essendo calcolabile creerà una linea vuota)
+              //solo per avere un nome per la baseline nella legenda (Le arrow non possono avere un nome)
+
+    for (int algo = 0; algo < n_policies; algo++) {
+      for (const ResultsSummary::PhaseSummary& phase : summary.phases[algo]) {
+        double phase_value = phase.phase+(0.04*algo)+0.01;
+        file_dati << phase_value << " " << phase.mean << " " << phase.st_dev << "\n";
+      }
+      file_dati << "e\n";
+    }
+  }
+
+}
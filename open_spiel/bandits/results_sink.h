@@ -0,0 +1,79 @@
+#ifndef RESULTS_SINK_H
+#define RESULTS_SINK_H
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "bandits/experiment_runner.h"
+
+namespace policies {
+
+  // Append-only CSV file of the results of a sweep, written while the sweep
+  // runs: every record is a line, flushed as soon as it is recorded, so the
+  // results of the completed phases survive a crash and the memory used does
+  // not grow with the size of the sweep. The columns are
+  //
+  //   kind,policy,rep,maze_rep,phase,value,label
+  //
+  // with kind "policy" (label is the description of the policy), "score" (the
+  // score of a phase of a run) or "baseline" (the score of the random policy
+  // on a repetition). Unused columns are empty.
+  // Can be used by several threads at once.
+  class ResultsSink {
+    public :
+      // If append, records are added to those already in the file (e.g. when
+      // resuming a sweep from its checkpoints), otherwise the file is
+      // rewritten.
+      ResultsSink(const std::string& path, bool append);
+
+      void RecordPolicy(int policy_index, const std::string& name);
+      void RecordScore(const ExperimentTask& task, int phase, double score);
+      void RecordBaseline(int rep, double score);
+
+      const std::string& path() const { return path_; }
+
+    private :
+      void Append(const std::string& line);
+
+      std::string path_;
+      std::mutex mutex_;
+      std::ofstream file_;
+  };
+
+  // Results of a sweep aggregated per policy and phase, as plotted.
+  struct ResultsSummary {
+    struct PhaseSummary {
+      int phase;     // Numbered from 1
+      int n_runs;    // Runs that reached the phase
+      double mean;
+      double st_dev; // As standard_deviation_calc
+    };
+
+    std::vector<std::string> policy_names;        // By policy index
+    std::vector<std::vector<PhaseSummary>> phases; // By policy index, in phase order
+    double baseline = 0;                          // Mean score of the random policy
+    int n_phases = 0;                             // Highest phase reached
+  };
+
+  // Reads a file written by ResultsSink. A record with the same kind, policy,
+  // repetition and phase as an earlier one replaces it (a resumed run may
+  // repeat the phase it was interrupted in), and an unterminated last line,
+  // left by a crash, is ignored. Scores are aggregated in repetition order,
+  // so the summary does not depend on the order the runs completed in.
+  ResultsSummary SummarizeResults(const std::string& path);
+
+  struct PlotOptions {
+    std::string title;
+    std::string ylabel;
+    std::string output; // Image written by gnuplot
+  };
+
+  // Writes a gnuplot script plotting mean and standard deviation of every
+  // policy per phase, with the baseline as a dashed line.
+  void WriteGnuplotScript(const ResultsSummary& summary, const PlotOptions& options, const std::string& path);
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+
+#include "running_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace policies {
+
+  void RunningStats::Add(double x, double decay_factor) {
+    count++;
+    weight = decay_factor * weight + 1;
+    weight2 = decay_factor * decay_factor * weight2 + 1;
+    m2 *= decay_factor;
+    double delta = x - mean;
+    mean += delta / weight;
+    m2 += delta * (x - mean);
+  }
+
+  void RunningStats::Remove(double x) {
+    SPIEL_CHECK_GT(count, 0);
+    if (count == 1) {
+      *this = RunningStats();
+      return;
+    }
+    count--;
+    weight -= 1;
+    weight2 -= 1;
+    double old_mean = mean;
+    mean = (old_mean * (weight + 1) - x) / weight;
+    m2 -= (x - mean) * (x - old_mean);
+    if (m2 < 0) //Errori di arrotondamento
+      m2 = 0;
+  }
+
+  ObservationTable::ObservationTable(StatsDecay decay) : decay_(decay) {
+    SPIEL_CHECK_GE(decay_.factor, StatsDecay::kMinFactor);
+    SPIEL_CHECK_LE(decay_.factor, 1);
+    SPIEL_CHECK_TRUE(decay_.window == 0 || decay_.window >= 2);
+    SPIEL_CHECK_TRUE(decay_.window == 0 || decay_.factor == 1);
+  }
+
+  void ObservationTable::Add(QStateId state, Action action, double observation) {
+    RunningStats& stats = stats_[{state, action}];
+    if (decay_.window > 0) {
+      std::deque<double>& window = windows_[{state, action}];
+      if (window.size() == decay_.window) {
+        stats.Remove(window.front());
+        window.pop_front();
+      }
+      window.push_back(observation);
+    }
+    stats.Add(observation, decay_.factor);
+  }
+
+  const RunningStats& ObservationTable::Get(QStateId state, Action action) const {
+    static const RunningStats kEmpty;
+    auto it = stats_.find({state, action});
+    return it == stats_.end() ? kEmpty : it->second;
+  }
+
+  size_t ObservationTable::MemoryUsage() const {
+    //Un byte di controllo per slot delle flat_hash_map
+    size_t bytes = stats_.capacity() * (sizeof(decltype(stats_)::value_type) + 1) +
+                   windows_.capacity() * (sizeof(decltype(windows_)::value_type) + 1);
+    for (const auto& [pair, window] : windows_)
+      bytes += window.size() * sizeof(double);
+    return bytes;
+  }
+
+  void ObservationTable::Clear() {
+    stats_.clear();
+    windows_.clear();
+  }
+
+  void ObservationTable::Save(open_spiel::CheckpointWriter* writer) const {
+    std::vector<std::pair<QStateId, Action>> keys;
+    keys.reserve(stats_.size());
+    for (const auto& [key, stats] : stats_)
+      keys.push_back(key);
+    std::sort(keys.begin(), keys.end()); //Stesso file per la stessa tabella
+
+    std::vector<QStateId> states;
+    std::vector<int64_t> actions, counts, window_sizes;
+    std::vector<double> weights, weights2, means, m2s, window_values;
+    for (const auto& key : keys) {
+      const RunningStats& stats = stats_.at(key);
+      states.push_back(key.first);
+      actions.push_back(key.second);
+      counts.push_back(stats.count);
+      weights.push_back(stats.weight);
+      weights2.push_back(stats.weight2);
+      means.push_back(stats.mean);
+      m2s.push_back(stats.m2);
+      if (decay_.window > 0) {
+        const std::deque<double>& window = windows_.at(key);
+        window_sizes.push_back(window.size());
+        window_values.insert(window_values.end(), window.begin(), window.end());
+      }
+    }
+
+    writer->Write<double>(decay_.factor);
+    writer->Write<int32_t>(decay_.window);
+    writer->WriteArray<QStateId>(states);
+    writer->WriteArray<int64_t>(actions);
+    writer->WriteArray<int64_t>(counts);
+    writer->WriteArray<double>(weights);
+    writer->WriteArray<double>(weights2);
+    writer->WriteArray<double>(means);
+    writer->WriteArray<double>(m2s);
+    writer->WriteArray<int64_t>(window_sizes);
+    writer->WriteArray<double>(window_values);
+  }
+
+  void ObservationTable::Load(open_spiel::CheckpointReader* reader) {
+    SPIEL_CHECK_EQ(reader->Read<double>(), decay_.factor);
+    SPIEL_CHECK_EQ(reader->Read<int32_t>(), decay_.window);
+    const std::vector<QStateId> states = reader->ReadArray<QStateId>();
+    const std::vector<int64_t> actions = reader->ReadArray<int64_t>();
+    const std::vector<int64_t> counts = reader->ReadArray<int64_t>();
+    const std::vector<double> weights = reader->ReadArray<double>();
+    const std::vector<double> weights2 = reader->ReadArray<double>();
+    const std::vector<double> means = reader->ReadArray<double>();
+    const std::vector<double> m2s = reader->ReadArray<double>();
+    const std::vector<int64_t> window_sizes = reader->ReadArray<int64_t>();
+    const std::vector<double> window_values = reader->ReadArray<double>();
+    SPIEL_CHECK_EQ(actions.size(), states.size());
+    SPIEL_CHECK_EQ(counts.size(), states.size());
+    SPIEL_CHECK_EQ(weights.size(), states.size());
+    SPIEL_CHECK_EQ(weights2.size(), states.size());
+    SPIEL_CHECK_EQ(means.size(), states.size());
+    SPIEL_CHECK_EQ(m2s.size(), states.size());
+    SPIEL_CHECK_EQ(window_sizes.size(), decay_.window > 0 ? states.size() : 0);
+
+    Clear();
+    size_t window_offset = 0;
+    for (int i = 0; i < states.size(); i++) {
+      const std::pair<QStateId, Action> key = {states[i], actions[i]};
+      stats_[key] = RunningStats{counts[i], weights[i], weights2[i], means[i], m2s[i]};
+      if (decay_.window > 0) {
+        SPIEL_CHECK_LE(window_offset + window_sizes[i], window_values.size());
+        windows_[key].assign(window_values.begin() + window_offset,
+                             window_values.begin() + window_offset + window_sizes[i]);
+        window_offset += window_sizes[i];
+      }
+    }
+  }
+
+}
@@ -0,0 +1,98 @@
+#ifndef RUNNING_STATS_H
+#define RUNNING_STATS_H
+
+#include <cstdint>
+#include <deque>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/spiel_globals.h"
+#include "bandits/generic_policy.h"
+
+namespace policies {
+
+  // How RunningStats forget old observations. The default keeps all of them.
+  struct StatsDecay {
+    // Smallest exponential factor accepted. With factor f the effective
+    // number of observations tends to (1 + f) / (1 - f), which is 3 at 0.5:
+    // below that the deviation estimated from so few observations is
+    // dominated by its small-sample correction and is no longer meaningful.
+    static constexpr double kMinFactor = 0.5;
+
+    // Exponential forgetting: at every new observation the weight of the
+    // previous ones is multiplied by factor, in [kMinFactor, 1]. 1 means no
+    // forgetting.
+    double factor = 1;
+    // Sliding window: if positive, only the last window observations are kept.
+    // At least 2, so that a deviation can be estimated. Can not be combined
+    // with an exponential factor.
+    int window = 0;
+
+    bool IsDefault() const { return factor == 1 && window == 0; }
+  };
+
+  // Constant-size summary of a stream of observations, updated with Welford's
+  // online algorithm (weighted by West's variant when decaying). Replaces the
+  // full list of observations: every update and query is O(1).
+  struct RunningStats {
+    int64_t count = 0; // Observations currently summarized
+    double weight = 0; // Sum of their weights (equal to count without decay)
+    double weight2 = 0; // Sum of the squared weights (as above)
+    double mean = 0;   // Weighted mean of the observations
+    double m2 = 0;     // Weighted sum of squared deviations from mean
+
+    // Adds an observation, first scaling the weight of the previous ones by
+    // decay_factor.
+    void Add(double x, double decay_factor = 1);
+
+    // Removes an observation previously added without decay.
+    void Remove(double x);
+
+    // Kish effective number of observations, weight^2 / weight2: equal to
+    // count without decay, smaller when the weights are uneven.
+    double EffectiveCount() const {
+      return weight2 > 0 ? weight * weight / weight2 : 0;
+    }
+
+    // Weighted sum of the squared deviations of the observations from center,
+    // which does not need to be their mean.
+    double SquaredDeviationsFrom(double center) const {
+      return m2 + weight * (mean - center) * (mean - center);
+    }
+  };
+
+  // Observation statistics of the VBR policies for every (state, action) pair
+  // of the Q-table they are bound to.
+  class ObservationTable {
+    public :
+      explicit ObservationTable(StatsDecay decay = StatsDecay());
+
+      void Add(QStateId state, Action action, double observation);
+
+      // Returns the statistics of the pair, empty if it was never observed.
+      // Never inserts a new entry.
+      const RunningStats& Get(QStateId state, Action action) const;
+
+      void Clear();
+
+      const StatsDecay& decay() const { return decay_; }
+
+      int64_t NumEntries() const { return stats_.size(); }
+
+      // Approximate heap memory of the statistics and of the windows.
+      size_t MemoryUsage() const;
+
+      // Statistics and windows of every pair, in order of (state, action). The
+      // decay must be the same when loading.
+      void Save(open_spiel::CheckpointWriter* writer) const;
+      void Load(open_spiel::CheckpointReader* reader);
+
+    private :
+      StatsDecay decay_;
+      absl::flat_hash_map<std::pair<QStateId, Action>, RunningStats> stats_;
+      // Observations inside the sliding window, used only if decay_.window > 0.
+      absl::flat_hash_map<std::pair<QStateId, Action>, std::deque<double>> windows_;
+  };
+
+}
+
+#endif
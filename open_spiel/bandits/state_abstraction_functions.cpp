@@ -1,5 +1,11 @@
 #include "state_abstraction_functions.h"
 
+#include <cmath>
+#include <cstdlib>
+
+#include "open_spiel/game_transforms/turn_based_simultaneous_game.h"
+#include "open_spiel/games/pathfinding.h"
+
 namespace policies {
   
 std::string visibility_limit_no_distinction(const std::string state_str) {
@@ -121,4 +127,78 @@ std::string identity (const std::string str) {
 }
 
 
+namespace {
+
+using open_spiel::pathfinding::PathfindingState;
+
+//Lo stato di pathfinding, anche se avvolto nella versione turn-based
+const PathfindingState& pathfinding_state(const State& state) {
+  if (auto* turn_based = dynamic_cast<const open_spiel::TurnBasedSimultaneousState*>(&state))
+    return open_spiel::down_cast<const PathfindingState&>(*turn_based->SimultaneousGameState());
+  return open_spiel::down_cast<const PathfindingState&>(state);
+}
+
+std::string pack_key(uint64_t key) {
+  return std::string(reinterpret_cast<const char*>(&key), sizeof(key));
+}
+
+std::string pathfinding_key(const State& state, bool with_move_count) {
+  if (state.CurrentPlayer() > 0 && dynamic_cast<const open_spiel::TurnBasedSimultaneousState*>(&state)) //Le azioni parziali non sono accessibili, e la chiave deve distinguerle
+    return state.ToString();
+  return pack_key(pathfinding_state(state).CompactKey(with_move_count)); //Le stringhe di ToString con azioni parziali sono piu' lunghe, non collidono
+}
+
+}
+
+std::string pathfinding_compact_key(const State& state) {
+  return pathfinding_key(state, false);
+}
+
+std::string pathfinding_compact_key_with_moves(const State& state) {
+  return pathfinding_key(state, true);
+}
+
+StateKeyFunction pathfinding_local_view(int radius, bool with_distinction) {
+  SPIEL_CHECK_GE(radius, 1);
+
+  //Spostamenti delle celle della vista, in ordine di riga e colonna
+  std::vector<std::pair<int, int>> offsets;
+  for (int dr = -radius; dr <= radius; dr++) {
+    for (int dc = -radius; dc <= radius; dc++) {
+      int distance = std::abs(dr) + std::abs(dc);
+      if (distance >= 1 && distance <= radius)
+        offsets.push_back({dr, dc});
+    }
+  }
+
+  //Codici delle celle: 0 vuota, 1 muro, 2 fuori griglia o altro giocatore (senza distinzione anche questi valgono come muro)
+  const uint64_t base = with_distinction ? 3 : 2;
+  SPIEL_CHECK_LE(offsets.size() * std::log2((double)base), 64);
+
+  return [offsets, base](const State& state) {
+    const PathfindingState& pf_state = pathfinding_state(state);
+    const auto [row, col] = pf_state.PlayerPos(0);
+    const uint64_t blocked = base - 1;
+    uint64_t key = 0;
+    for (const auto& [dr, dc] : offsets) {
+      int r = row + dr;
+      int c = col + dc;
+      uint64_t code = blocked;
+      if (r >= 0 && r < pf_state.NumRows() && c >= 0 && c < pf_state.NumCols()) {
+        int cell = pf_state.CellAt(r, c);
+        if (cell == open_spiel::pathfinding::kEmpty)
+          code = 0;
+        else if (cell == open_spiel::pathfinding::kWall)
+          code = 1;
+      }
+      key = key * base + code;
+    }
+    return pack_key(key);
+  };
+}
+
+std::string hash_key(const State& state) {
+  return pack_key(state.HashKey());
+}
+
 }
@@ -6,6 +6,8 @@
 
 #include <iostream>
 #include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/spiel.h"
+#include "bandits/generic_policy.h"
 
 namespace policies {
   
@@ -15,6 +17,23 @@ std::string visibility_limit_with_distinction(const std::string state_str);
 
 std::string identity (const std::string str);
 
+//Chiavi di stato calcolate direttamente sullo stato, senza passare per ToString (vedi StateKeyFunction)
+
+//Chiave compatta di pathfinding (anche in versione turn-based): 8 byte con le posizioni dei giocatori, equivalente a identity.
+//Se lo stato turn-based ha azioni parziali in sospeso (piu' giocatori) usa ToString
+std::string pathfinding_compact_key(const State& state);
+
+//Come sopra, ma la chiave include anche il numero di mosse giocate
+std::string pathfinding_compact_key_with_moves(const State& state);
+
+//Vista locale di raggio radius attorno al giocatore 0 di pathfinding, letta direttamente dalla griglia dello stato: le celle a distanza
+//di Manhattan 1..radius, ciascuna codificata come vuota, muro o (con with_distinction) fuori griglia/altro giocatore, impacchettate in un
+//intero di 8 byte. Con radius 1 partiziona gli stati come visibility_limit_with_distinction/visibility_limit_no_distinction
+StateKeyFunction pathfinding_local_view(int radius, bool with_distinction);
+
+//Chiave di 8 byte con State::HashKey, per qualsiasi gioco: equivalente a identity a meno di collisioni dell'hash a 64 bit
+std::string hash_key(const State& state);
+
 }
 
 #endif
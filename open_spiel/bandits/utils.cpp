@@ -18,6 +18,18 @@ namespace policies {
     return (sqrt(variance))/(list.size()-1);
   }
 
+  double standard_deviation_calc(const RunningStats& stats, double mean) {
+    if (stats.count < 2)
+      return 0;
+
+    //Con decadimento si usa il numero effettivo di osservazioni al posto di
+    //weight: ratio = EffectiveCount()/weight, esattamente 1 senza decadimento
+    double ratio = stats.weight / stats.weight2;
+    double effective_count = stats.weight * ratio;
+
+    return (sqrt(stats.SquaredDeviationsFrom(mean) * ratio))/(effective_count-1);
+  }
+
   double average_of(std::vector<double> vec) {
 
     if (vec.empty())
@@ -31,21 +43,37 @@ namespace policies {
   }
 
   Action GetOptimalAction(
-    absl::flat_hash_map<std::pair<std::string, Action>, double>* q_values,
+    const QTable* q_values,
     const State& state, StateAbstractionFunction func) { 
 
     std::vector<Action> legal_actions = state.LegalActions();
-    Action optimal_action = open_spiel::kInvalidAction;
-
-    double value = -1;
-    for (const Action& action : legal_actions) {
-      double q_val = (*q_values)[{func(state.ToString()), action}];
-      if (q_val >= value) {
-        value = q_val;
-        optimal_action = action;
-      }
-    }
-    return optimal_action;
+    const QStateId state_id = q_values->FindState(func(state.ToString()));
+
+    return q_values->GreedyAction(state_id, legal_actions, -1,
+                                  open_spiel::kInvalidAction).action;
+  }
+
+  Action GetOptimalAction(
+    const QTable* q_values,
+    const State& state, const StateKeyFunction& key_func) {
+
+    std::vector<Action> legal_actions = state.LegalActions();
+    const QStateId state_id = q_values->FindState(key_func(state));
+
+    return q_values->GreedyAction(state_id, legal_actions, -1,
+                                  open_spiel::kInvalidAction).action;
+  }
+
+  FrozenGreedyPolicy::FrozenGreedyPolicy(const QTable& q_values, StateKeyFunction key_func)
+      : table_(std::make_shared<const open_spiel::algorithms::FrozenQTable>(q_values.Freeze())),
+        key_func_(std::move(key_func)) {}
+
+  Action FrozenGreedyPolicy::operator()(const State& state) const {
+    std::vector<Action> legal_actions = state.LegalActions();
+    const QStateId state_id = table_->FindState(key_func_(state));
+
+    return table_->GreedyAction(state_id, legal_actions, -1,
+                                open_spiel::kInvalidAction).action;
   }
 
 }
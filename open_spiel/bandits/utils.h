@@ -9,6 +9,7 @@
 #include "open_spiel/spiel.h"
 #include "open_spiel/spiel_globals.h"
 #include "open_spiel/spiel_utils.h"
+#include "bandits/running_stats.h"
 
 using open_spiel::Action;
 using open_spiel::Game;
@@ -18,12 +19,34 @@ using open_spiel::State;
 namespace policies {
 
   double standard_deviation_calc(std::vector<double> list, double mean);
+  double standard_deviation_calc(const RunningStats& stats, double mean); //Come sopra, ma a partire dalle statistiche in streaming
   double average_of(std::vector<double> vec);
 
   Action GetOptimalAction(
-    absl::flat_hash_map<std::pair<std::string, Action>, double>* q_values,
+    const QTable* q_values,
     const State& state, StateAbstractionFunction func);
 
+  //Come sopra, per tabelle indicizzate con una StateKeyFunction
+  Action GetOptimalAction(
+    const QTable* q_values,
+    const State& state, const StateKeyFunction& key_func);
+
+  //Politica greedy su una copia congelata della tabella (vedi QTable::Freeze): la tabella originale puo' continuare
+  //ad essere addestrata, e la copia puo' essere letta da piu' thread insieme
+  class FrozenGreedyPolicy {
+    public :
+      FrozenGreedyPolicy(const QTable& q_values, StateKeyFunction key_func);
+
+      //L'azione legale di valore massimo (a parita' l'ultima), come GetOptimalAction
+      Action operator()(const State& state) const;
+
+      const open_spiel::algorithms::FrozenQTable& table() const { return *table_; }
+
+    private :
+      std::shared_ptr<const open_spiel::algorithms::FrozenQTable> table_;
+      StateKeyFunction key_func_;
+  };
+
 }
 
 #endif
@@ -0,0 +1,139 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/algorithms/concurrent_q_table.h"
+
+#include <thread>
+
+#include "open_spiel/abseil-cpp/absl/hash/hash.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+ConcurrentQTable::ConcurrentQTable(int num_actions, int max_states)
+    : num_actions_(num_actions), max_states_(max_states) {
+  SPIEL_CHECK_GT(num_actions_, 0);
+  SPIEL_CHECK_GT(max_states_, 0);
+  SPIEL_CHECK_LT(max_states_, kBusySlot);
+  keys_ = std::make_unique<std::string[]>(max_states_);
+  const size_t num_values = static_cast<size_t>(max_states_) * num_actions_;
+  values_ = std::make_unique<std::atomic<double>[]>(num_values);
+  for (size_t i = 0; i < num_values; ++i) {
+    values_[i].store(0.0, std::memory_order_relaxed);
+  }
+  // At most half full, so that probe sequences stay short.
+  size_t num_slots = 2;
+  while (num_slots < 2 * static_cast<size_t>(max_states_)) num_slots *= 2;
+  slot_mask_ = num_slots - 1;
+  slots_ = std::make_unique<Slot[]>(num_slots);
+}
+
+QStateId ConcurrentQTable::PublishedId(const Slot& slot) const {
+  QStateId id = slot.id.load(std::memory_order_acquire);
+  while (id == kBusySlot) {
+    // Another thread is writing the key; this only lasts a string copy.
+    std::this_thread::yield();
+    id = slot.id.load(std::memory_order_acquire);
+  }
+  return id;
+}
+
+QStateId ConcurrentQTable::FindState(absl::string_view state) const {
+  const uint64_t hash = absl::Hash<absl::string_view>()(state);
+  for (size_t i = hash & slot_mask_;; i = (i + 1) & slot_mask_) {
+    const QStateId id = PublishedId(slots_[i]);
+    if (id == kEmptySlot) return kInvalidQStateId;
+    if (slots_[i].hash == hash && keys_[id] == state) return id;
+  }
+}
+
+QStateId ConcurrentQTable::AddState(absl::string_view state) {
+  const uint64_t hash = absl::Hash<absl::string_view>()(state);
+  for (size_t i = hash & slot_mask_;; i = (i + 1) & slot_mask_) {
+    Slot& slot = slots_[i];
+    QStateId id = PublishedId(slot);
+    if (id == kEmptySlot) {
+      QStateId expected = kEmptySlot;
+      if (slot.id.compare_exchange_strong(expected, kBusySlot,
+                                          std::memory_order_acquire)) {
+        id = num_states_.fetch_add(1, std::memory_order_relaxed);
+        if (id >= max_states_) {
+          SpielFatalError(absl::StrCat("ConcurrentQTable is full: more than ",
+                                       max_states_, " states"));
+        }
+        keys_[id] = std::string(state);
+        slot.hash = hash;
+        slot.id.store(id, std::memory_order_release);
+        return id;
+      }
+      // Another thread claimed the slot first, maybe for the same key.
+      id = PublishedId(slot);
+    }
+    if (slot.hash == hash && keys_[id] == state) return id;
+  }
+}
+
+const std::string& ConcurrentQTable::StateKey(QStateId id) const {
+  SPIEL_CHECK_LT(id, NumStates());
+  return keys_[id];
+}
+
+absl::Span<const double> ConcurrentQTable::Row(QStateId id,
+                                               QRowBuffer* buffer) const {
+  buffer->resize(num_actions_);
+  for (Action action = 0; action < num_actions_; ++action) {
+    (*buffer)[action] = Value(id, action);
+  }
+  return absl::MakeConstSpan(*buffer);
+}
+
+void ConcurrentQTable::AddToValue(QStateId id, Action action, double delta) {
+  std::atomic<double>& value = values_[Index(id, action)];
+  double current = value.load(std::memory_order_relaxed);
+  while (!value.compare_exchange_weak(current, current + delta,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+size_t ConcurrentQTable::MemoryUsage() const {
+  size_t bytes = static_cast<size_t>(max_states_) *
+                     (sizeof(std::string) + num_actions_ * sizeof(double)) +
+                 (slot_mask_ + 1) * sizeof(Slot);
+  const int num_states = NumStates();
+  for (int id = 0; id < num_states; ++id) {
+    if (keys_[id].capacity() > std::string().capacity()) {
+      bytes += keys_[id].capacity() + 1;  // Not stored inline.
+    }
+  }
+  return bytes;
+}
+
+void ConcurrentQTable::Clear() {
+  const int num_states = NumStates();
+  for (int id = 0; id < num_states; ++id) {
+    keys_[id] = std::string();
+    for (Action action = 0; action < num_actions_; ++action) {
+      SetValue(id, action, 0.0);
+    }
+  }
+  for (size_t i = 0; i <= slot_mask_; ++i) {
+    slots_[i].id.store(kEmptySlot, std::memory_order_relaxed);
+    slots_[i].hash = 0;
+  }
+  num_states_.store(0, std::memory_order_release);
+}
+
+}  // namespace algorithms
+}  // namespace open_spiel
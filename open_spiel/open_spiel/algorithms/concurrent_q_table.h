@@ -0,0 +1,112 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_ALGORITHMS_CONCURRENT_Q_TABLE_H_
+#define OPEN_SPIEL_ALGORITHMS_CONCURRENT_Q_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "open_spiel/abseil-cpp/absl/strings/string_view.h"
+#include "open_spiel/abseil-cpp/absl/types/span.h"
+#include "open_spiel/algorithms/q_table.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+// Lock-free QTable for Hogwild-style training, where several threads run
+// episodes against the same table (see
+// TabularQLearningSolver::RunIterationsConcurrently).
+//
+// The table is sized for at most max_states states when it is built: keys,
+// values and an open-addressing index of the ids are allocated once and
+// never move. AddState claims an index slot with a compare-and-swap and
+// publishes the new id once its key is written, so concurrent lookups and
+// insertions of the same key agree on a single id. Values are atomic doubles:
+// SetValue is a relaxed store and AddToValue a compare-and-swap loop, so no
+// update is lost, but updates of the same pair from different threads are
+// applied in no particular order. Every read is an atomic load: Row copies
+// the values one by one, so a row read during concurrent updates may mix
+// values from before and after them.
+//
+// Clear, Load and the count returned by NumStates while insertions are in
+// progress are not thread-safe; call them when no other thread uses the
+// table.
+class ConcurrentQTable : public QTable {
+ public:
+  ConcurrentQTable(int num_actions, int max_states);
+
+  QStateId FindState(absl::string_view state) const override;
+  QStateId AddState(absl::string_view state) override;
+  const std::string& StateKey(QStateId id) const override;
+
+  absl::Span<const double> Row(QStateId id,
+                               QRowBuffer* buffer) const override;
+
+  double Value(QStateId id, Action action) const override {
+    return values_[Index(id, action)].load(std::memory_order_relaxed);
+  }
+  void SetValue(QStateId id, Action action, double value) override {
+    values_[Index(id, action)].store(value, std::memory_order_relaxed);
+  }
+  void AddToValue(QStateId id, Action action, double delta) override;
+
+  int NumStates() const override {
+    return num_states_.load(std::memory_order_acquire);
+  }
+  int NumActions() const override { return num_actions_; }
+  int MaxStates() const { return max_states_; }
+
+  size_t MemoryUsage() const override;
+
+  bool SupportsConcurrentUpdates() const override { return true; }
+
+  void Clear() override;
+
+ private:
+  // Slot ids that are not the id of a state.
+  static constexpr QStateId kEmptySlot = kInvalidQStateId;
+  static constexpr QStateId kBusySlot = kInvalidQStateId - 1;
+
+  struct Slot {
+    std::atomic<QStateId> id{kEmptySlot};
+    uint64_t hash = 0;  // Written before id is published.
+  };
+
+  size_t Index(QStateId id, Action action) const {
+    SPIEL_DCHECK_LT(id, num_states_.load(std::memory_order_relaxed));
+    SPIEL_DCHECK_GE(action, 0);
+    SPIEL_DCHECK_LT(action, num_actions_);
+    return static_cast<size_t>(id) * num_actions_ + action;
+  }
+
+  // Waits until the id of the slot is published, then returns it
+  // (kEmptySlot if the slot is empty).
+  QStateId PublishedId(const Slot& slot) const;
+
+  const int num_actions_;
+  const int max_states_;
+  std::atomic<int> num_states_{0};
+  std::unique_ptr<std::string[]> keys_;
+  std::unique_ptr<std::atomic<double>[]> values_;
+  size_t slot_mask_;  // Number of slots - 1, a power of two.
+  std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace algorithms
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_ALGORITHMS_CONCURRENT_Q_TABLE_H_
@@ -0,0 +1,106 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/algorithms/concurrent_q_table.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/spiel_utils.h"
+
+namespace open_spiel {
+namespace algorithms {
+namespace {
+
+constexpr int kNumThreads = 4;
+
+// Runs fn(thread) on kNumThreads threads, released at the same time so that
+// they race as much as possible.
+template <typename Fn>
+void RunOnThreads(const Fn& fn) {
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&go, &fn, t] {
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      fn(t);
+    });
+  }
+  go.store(true, std::memory_order_release);
+  for (std::thread& thread : threads) thread.join();
+}
+
+void TestRacingAddStateGivesOneId() {
+  constexpr int kNumKeys = 20000;
+  ConcurrentQTable table(2, kNumKeys);
+  // Every thread adds every key, in a different order.
+  std::vector<std::vector<QStateId>> ids(kNumThreads,
+                                         std::vector<QStateId>(kNumKeys));
+  RunOnThreads([&](int t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      const int key = t % 2 == 0 ? i : kNumKeys - 1 - i;
+      ids[t][key] = table.AddState(absl::StrCat("state ", key));
+    }
+  });
+
+  SPIEL_CHECK_EQ(table.NumStates(), kNumKeys);
+  for (int key = 0; key < kNumKeys; ++key) {
+    const QStateId id = ids[0][key];
+    for (int t = 1; t < kNumThreads; ++t) SPIEL_CHECK_EQ(ids[t][key], id);
+    SPIEL_CHECK_EQ(table.StateKey(id), absl::StrCat("state ", key));
+    SPIEL_CHECK_EQ(table.FindState(absl::StrCat("state ", key)), id);
+  }
+}
+
+void TestConcurrentAddToValueLosesNoUpdate() {
+  constexpr int kNumKeys = 64;
+  constexpr int kUpdatesPerThread = 200000;
+  ConcurrentQTable table(3, kNumKeys);
+  RunOnThreads([&](int t) {
+    for (int i = 0; i < kUpdatesPerThread; ++i) {
+      const QStateId id = table.AddState(absl::StrCat(i % kNumKeys));
+      table.AddToValue(id, i % 3, 1.0);
+    }
+  });
+
+  double total = 0;
+  QRowBuffer buffer;
+  for (QStateId id = 0; id < table.NumStates(); ++id) {
+    for (double value : table.Row(id, &buffer)) total += value;
+  }
+  // Sums of integers are exact in double.
+  SPIEL_CHECK_EQ(total, static_cast<double>(kNumThreads) * kUpdatesPerThread);
+}
+
+void TestClear() {
+  ConcurrentQTable table(2, 8);
+  table.AddToValue(table.AddState("a"), 1, 2.0);
+  table.Clear();
+  SPIEL_CHECK_EQ(table.NumStates(), 0);
+  SPIEL_CHECK_EQ(table.FindState("a"), kInvalidQStateId);
+  SPIEL_CHECK_EQ(table.Value(table.AddState("a"), 1), 0.0);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace open_spiel
+
+int main(int argc, char** argv) {
+  open_spiel::algorithms::TestRacingAddStateGivesOneId();
+  open_spiel::algorithms::TestConcurrentAddToValueLosesNoUpdate();
+  open_spiel::algorithms::TestClear();
+}
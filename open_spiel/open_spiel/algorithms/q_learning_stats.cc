@@ -0,0 +1,72 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/algorithms/q_learning_stats.h"
+
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_format.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+double QLearningStats::EpisodesPerSecond() const {
+  return total_ns > 0 ? episodes * 1e9 / total_ns : 0;
+}
+
+double QLearningStats::StepsPerSecond() const {
+  return total_ns > 0 ? steps * 1e9 / total_ns : 0;
+}
+
+double QLearningStats::SectionFraction(Section section) const {
+  return total_ns > 0 ? static_cast<double>(section_ns[section]) / total_ns
+                      : 0;
+}
+
+std::string QLearningStats::ToJson() const {
+  std::string sections;
+  for (int section = 0; section < kNumSections; ++section) {
+    absl::StrAppend(
+        &sections, section == 0 ? "" : ", ",
+        absl::StrFormat("\"%s\": {\"ns\": %d, \"fraction\": %.4f}",
+                        SectionName(static_cast<Section>(section)),
+                        section_ns[section],
+                        SectionFraction(static_cast<Section>(section))));
+  }
+  return absl::StrFormat(
+      "{\"episodes\": %d, \"steps\": %d, \"episodes_per_second\": %.1f, "
+      "\"steps_per_second\": %.1f, \"key_lookups\": %d, \"new_states\": %d, "
+      "\"total_ns\": %d, \"sections\": {%s}, \"table_states\": %d, "
+      "\"table_bytes\": %d, \"trace_entries\": %d, \"policy_bytes\": %d}",
+      episodes, steps, EpisodesPerSecond(), StepsPerSecond(), key_lookups,
+      new_states, total_ns, sections, table_states, table_bytes,
+      trace_entries, policy_bytes);
+}
+
+const char* SectionName(QLearningStats::Section section) {
+  switch (section) {
+    case QLearningStats::kEnvironment:
+      return "environment";
+    case QLearningStats::kStateKey:
+      return "state_key";
+    case QLearningStats::kSelection:
+      return "selection";
+    case QLearningStats::kUpdate:
+      return "update";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace algorithms
+}  // namespace open_spiel
@@ -0,0 +1,72 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_ALGORITHMS_Q_LEARNING_STATS_H_
+#define OPEN_SPIEL_ALGORITHMS_Q_LEARNING_STATS_H_
+
+#include <cstdint>
+#include <string>
+
+namespace open_spiel {
+namespace algorithms {
+
+// Runtime counters of a TabularQLearningSolver, collected only while enabled
+// with TabularQLearningSolver::EnableStats.
+//
+// The counters accumulate over the training calls since they were last
+// reset; the sizes describe the solver when the stats were queried.
+struct QLearningStats {
+  // Parts of a training step that the wall time is split into.
+  enum Section {
+    kEnvironment,  // New states, children, chance sampling, legal actions.
+    kStateKey,     // Building the state key and interning it in the table.
+    kSelection,    // Action selection by the policy.
+    kUpdate,       // TD target, value and trace updates, policy statistics.
+    kNumSections
+  };
+
+  int64_t episodes = 0;
+  int64_t steps = 0;
+  // Keys interned in the Q-table, one hash probe of its index each, and how
+  // many of them added a new state.
+  int64_t key_lookups = 0;
+  int64_t new_states = 0;
+  // Wall time of the training calls, and of each section within them. With
+  // RunIterationsConcurrently the section times are summed over the threads,
+  // so their fractions add up to about the number of threads.
+  int64_t total_ns = 0;
+  int64_t section_ns[kNumSections] = {};
+
+  // Sizes at query time. Byte counts are approximate heap usage.
+  int64_t table_states = 0;
+  int64_t table_bytes = 0;
+  int64_t trace_entries = 0;
+  int64_t policy_bytes = 0;
+
+  double EpisodesPerSecond() const;
+  double StepsPerSecond() const;
+  // Fraction of the total time spent in section.
+  double SectionFraction(Section section) const;
+
+  // Counters and rates as a JSON object, for logs and dashboards.
+  std::string ToJson() const;
+};
+
+// Name of a section in ToJson.
+const char* SectionName(QLearningStats::Section section);
+
+}  // namespace algorithms
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_ALGORITHMS_Q_LEARNING_STATS_H_
@@ -0,0 +1,297 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/algorithms/q_table.h"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "open_spiel/abseil-cpp/absl/hash/hash.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+QGreedyAction GreedyAction(absl::Span<const double> row,
+                           absl::Span<const Action> legal_actions,
+                           double min_value, Action fallback) {
+  auto value_of = [row](Action action) {
+    return row.empty() ? 0.0 : row[action];
+  };
+
+  QGreedyAction best{kInvalidAction, min_value};
+  for (Action action : legal_actions) {
+    double q_val = value_of(action);
+    if (q_val >= best.value) {
+      best = {action, q_val};
+    }
+  }
+  if (best.action == kInvalidAction && fallback != kInvalidAction) {
+    best = {fallback, value_of(fallback)};
+  }
+  return best;
+}
+
+double QTable::Lookup(absl::string_view state, Action action) const {
+  QStateId id = FindState(state);
+  if (id == kInvalidQStateId) {
+    return 0;
+  }
+  return Value(id, action);
+}
+
+QGreedyAction QTable::GreedyAction(QStateId id,
+                                   absl::Span<const Action> legal_actions,
+                                   double min_value, Action fallback) const {
+  QRowBuffer buffer;
+  return algorithms::GreedyAction(
+      id == kInvalidQStateId ? absl::Span<const double>() : Row(id, &buffer),
+      legal_actions, min_value, fallback);
+}
+
+FrozenQTable QTable::Freeze() const { return FrozenQTable(*this); }
+
+void QTable::Save(CheckpointWriter* writer) const {
+  const int num_states = NumStates();
+  writer->Write<int32_t>(NumActions());
+  std::vector<uint64_t> key_offsets;
+  key_offsets.reserve(num_states + 1);
+  key_offsets.push_back(0);
+  std::string key_data;
+  std::vector<double> values;
+  values.reserve(static_cast<size_t>(num_states) * NumActions());
+  QRowBuffer buffer;
+  for (QStateId id = 0; id < num_states; ++id) {
+    key_data += StateKey(id);
+    key_offsets.push_back(key_data.size());
+    absl::Span<const double> row = Row(id, &buffer);
+    values.insert(values.end(), row.begin(), row.end());
+  }
+  writer->WriteArray<uint64_t>(key_offsets);
+  writer->WriteString(key_data);
+  writer->WriteArray<double>(values);
+}
+
+void QTable::Load(CheckpointReader* reader) {
+  const int num_actions = reader->Read<int32_t>();
+  SPIEL_CHECK_EQ(num_actions, NumActions());
+  const std::vector<uint64_t> key_offsets = reader->ReadArray<uint64_t>();
+  const std::string key_data = reader->ReadString();
+  const std::vector<double> values = reader->ReadArray<double>();
+  SPIEL_CHECK_FALSE(key_offsets.empty());
+  const size_t num_states = key_offsets.size() - 1;
+  SPIEL_CHECK_EQ(key_offsets.back(), key_data.size());
+  SPIEL_CHECK_EQ(values.size(), num_states * num_actions);
+
+  Clear();
+  for (size_t i = 0; i < num_states; ++i) {
+    const QStateId id = AddState(absl::string_view(key_data).substr(
+        key_offsets[i], key_offsets[i + 1] - key_offsets[i]));
+    SPIEL_CHECK_EQ(id, i);  // Fails if the saved keys were not distinct.
+    for (Action action = 0; action < num_actions; ++action) {
+      SetValue(id, action, values[i * num_actions + action]);
+    }
+  }
+}
+
+DenseQTable::DenseQTable(int num_actions) : num_actions_(num_actions) {
+  SPIEL_CHECK_GT(num_actions_, 0);
+}
+
+QStateId DenseQTable::FindState(absl::string_view state) const {
+  auto it = index_.find(state);
+  return it == index_.end() ? kInvalidQStateId : it->second;
+}
+
+QStateId DenseQTable::AddState(absl::string_view state) {
+  auto it = index_.find(state);
+  if (it != index_.end()) {
+    return it->second;
+  }
+  SPIEL_CHECK_LT(keys_.size(), kInvalidQStateId);
+  QStateId id = keys_.size();
+  keys_.emplace_back(state);
+  key_bytes_ += sizeof(std::string);
+  if (keys_.back().capacity() > std::string().capacity()) {
+    key_bytes_ += keys_.back().capacity() + 1;  // Not stored inline.
+  }
+  index_.emplace(keys_.back(), id);
+  values_.resize(values_.size() + num_actions_, 0.0);
+  return id;
+}
+
+const std::string& DenseQTable::StateKey(QStateId id) const {
+  SPIEL_CHECK_LT(id, keys_.size());
+  return keys_[id];
+}
+
+size_t DenseQTable::MemoryUsage() const {
+  // One control byte per slot of the flat hash map.
+  return key_bytes_ +
+         index_.capacity() * (sizeof(decltype(index_)::value_type) + 1) +
+         values_.capacity() * sizeof(double);
+}
+
+void DenseQTable::Clear() {
+  index_.clear();
+  keys_.clear();
+  key_bytes_ = 0;
+  values_.clear();
+}
+
+namespace {
+uint64_t KeyHash(absl::string_view key) {
+  return absl::Hash<absl::string_view>()(key);
+}
+}  // namespace
+
+FrozenQTable::FrozenQTable(const QTable& table)
+    : num_actions_(table.NumActions()) {
+  const int num_states = table.NumStates();
+  key_offsets_.reserve(num_states + 1);
+  key_offsets_.push_back(0);
+  values_.reserve(static_cast<size_t>(num_states) * num_actions_);
+  QRowBuffer buffer;
+  for (QStateId id = 0; id < num_states; ++id) {
+    key_data_ += table.StateKey(id);
+    key_offsets_.push_back(key_data_.size());
+    absl::Span<const double> row = table.Row(id, &buffer);
+    values_.insert(values_.end(), row.begin(), row.end());
+  }
+
+  size_t num_slots = 2;
+  while (num_slots < 2 * static_cast<size_t>(num_states)) num_slots *= 2;
+  slots_.assign(num_slots, Slot{0, kInvalidQStateId});
+  for (QStateId id = 0; id < num_states; ++id) {
+    const uint64_t hash = KeyHash(StateKey(id));
+    size_t i = hash & (num_slots - 1);
+    while (slots_[i].id != kInvalidQStateId) i = (i + 1) & (num_slots - 1);
+    slots_[i] = {hash, id};
+  }
+}
+
+QStateId FrozenQTable::FindState(absl::string_view state) const {
+  const uint64_t hash = KeyHash(state);
+  const size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask; slots_[i].id != kInvalidQStateId;
+       i = (i + 1) & mask) {
+    const QStateId id = slots_[i].id;
+    if (slots_[i].hash == hash &&
+        absl::string_view(key_data_).substr(
+            key_offsets_[id], key_offsets_[id + 1] - key_offsets_[id]) ==
+            state) {
+      return id;
+    }
+  }
+  return kInvalidQStateId;
+}
+
+absl::string_view FrozenQTable::StateKey(QStateId id) const {
+  SPIEL_CHECK_LT(id, NumStates());
+  return absl::string_view(key_data_).substr(
+      key_offsets_[id], key_offsets_[id + 1] - key_offsets_[id]);
+}
+
+QGreedyAction FrozenQTable::GreedyAction(
+    QStateId id, absl::Span<const Action> legal_actions, double min_value,
+    Action fallback) const {
+  return algorithms::GreedyAction(
+      id == kInvalidQStateId ? absl::Span<const double>() : Row(id),
+      legal_actions, min_value, fallback);
+}
+
+EligibilityTraces::EligibilityTraces(double threshold)
+    : threshold_(threshold) {
+  SPIEL_CHECK_GE(threshold_, 0);
+}
+
+void EligibilityTraces::Accumulate(QStateId id, Action action,
+                                   double amount) {
+  auto [it, inserted] = positions_.insert(
+      {{id, action}, static_cast<int>(entries_.size())});
+  if (inserted) {
+    entries_.push_back({id, action, amount});
+  } else {
+    entries_[it->second].trace += amount;
+  }
+}
+
+void EligibilityTraces::UpdateAndDecay(QTable* values, double step,
+                                       double decay) {
+  if (decay == 0) {
+    // Reset after an exploratory action: no need to decay trace by trace.
+    for (const Entry& entry : entries_) {
+      values->AddToValue(entry.id, entry.action, step * entry.trace);
+    }
+    Clear();
+    return;
+  }
+  for (int i = 0; i < entries_.size();) {
+    Entry& entry = entries_[i];
+    values->AddToValue(entry.id, entry.action, step * entry.trace);
+    entry.trace *= decay;
+    if (std::abs(entry.trace) <= threshold_) {
+      // The last entry takes its place and is visited next.
+      Remove(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void EligibilityTraces::Clear() {
+  entries_.clear();
+  positions_.clear();
+}
+
+void EligibilityTraces::Save(CheckpointWriter* writer) const {
+  std::vector<QStateId> ids;
+  std::vector<int64_t> actions;
+  std::vector<double> traces;
+  for (const Entry& entry : entries_) {
+    ids.push_back(entry.id);
+    actions.push_back(entry.action);
+    traces.push_back(entry.trace);
+  }
+  writer->Write<double>(threshold_);
+  writer->WriteArray<QStateId>(ids);
+  writer->WriteArray<int64_t>(actions);
+  writer->WriteArray<double>(traces);
+}
+
+void EligibilityTraces::Load(CheckpointReader* reader) {
+  threshold_ = reader->Read<double>();
+  const std::vector<QStateId> ids = reader->ReadArray<QStateId>();
+  const std::vector<int64_t> actions = reader->ReadArray<int64_t>();
+  const std::vector<double> traces = reader->ReadArray<double>();
+  SPIEL_CHECK_EQ(ids.size(), actions.size());
+  SPIEL_CHECK_EQ(ids.size(), traces.size());
+  Clear();
+  for (int i = 0; i < ids.size(); ++i) {
+    Accumulate(ids[i], actions[i], traces[i]);
+  }
+}
+
+void EligibilityTraces::Remove(int position) {
+  positions_.erase({entries_[position].id, entries_[position].action});
+  if (position != entries_.size() - 1) {
+    entries_[position] = entries_.back();
+    positions_[{entries_[position].id, entries_[position].action}] = position;
+  }
+  entries_.pop_back();
+}
+
+}  // namespace algorithms
+}  // namespace open_spiel
@@ -0,0 +1,268 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_ALGORITHMS_Q_TABLE_H_
+#define OPEN_SPIEL_ALGORITHMS_Q_TABLE_H_
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/abseil-cpp/absl/container/inlined_vector.h"
+#include "open_spiel/abseil-cpp/absl/strings/string_view.h"
+#include "open_spiel/abseil-cpp/absl/types/span.h"
+#include "open_spiel/spiel_globals.h"
+#include "open_spiel/spiel_utils.h"
+#include "open_spiel/utils/binary_checkpoint.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+// Dense identifier of an (abstracted) state inside a QTable. Ids are assigned
+// in order of first insertion, starting from 0.
+using QStateId = uint32_t;
+inline constexpr QStateId kInvalidQStateId =
+    std::numeric_limits<QStateId>::max();
+
+// Storage that a QTable may copy the values of a row into (see QTable::Row).
+using QRowBuffer = absl::InlinedVector<double, 16>;
+
+// Result of a greedy selection over the action values of one state.
+struct QGreedyAction {
+  Action action;
+  double value;
+};
+
+// Returns the legal action with the highest value in row, scanning
+// legal_actions in order and keeping the last of tied actions. Only values
+// greater than or equal to min_value are considered: if none is, fallback is
+// returned, with its value in row (or min_value if fallback is
+// kInvalidAction). An empty row stands for a state whose values are all 0.
+QGreedyAction GreedyAction(absl::Span<const double> row,
+                           absl::Span<const Action> legal_actions,
+                           double min_value, Action fallback);
+
+class FrozenQTable;
+
+// Action-value table shared by the tabular Q-learning solver and the bandit
+// policies.
+//
+// State keys (usually the output of a StateAbstractionFunction) are interned
+// once into a dense QStateId, so that callers can hash the key a single time
+// per decision and then address the values of every action through the id.
+// Actions must lie in [0, NumActions()). Values of pairs that were never
+// written are 0.
+class QTable {
+ public:
+  virtual ~QTable() = default;
+
+  // Returns the id of the given state key, or kInvalidQStateId if the state
+  // has never been added. Never modifies the table.
+  virtual QStateId FindState(absl::string_view state) const = 0;
+
+  // Returns the id of the given state key, adding a zero-initialized row of
+  // action values if the state is new.
+  virtual QStateId AddState(absl::string_view state) = 0;
+
+  // Returns the key the state with the given id was added with.
+  virtual const std::string& StateKey(QStateId id) const = 0;
+
+  // Read-only view of the values of every action of the state, indexed by
+  // action. Tables that store plain doubles return a view of their storage;
+  // tables that support concurrent updates copy the values into buffer with
+  // atomic loads and return a view of it. The view is invalidated by the next
+  // AddState, Clear or reuse of buffer.
+  virtual absl::Span<const double> Row(QStateId id,
+                                       QRowBuffer* buffer) const = 0;
+
+  virtual double Value(QStateId id, Action action) const = 0;
+  virtual void SetValue(QStateId id, Action action, double value) = 0;
+  virtual void AddToValue(QStateId id, Action action, double delta) = 0;
+
+  virtual int NumStates() const = 0;
+  virtual int NumActions() const = 0;
+
+  // Approximate heap memory held by the keys, the index and the values.
+  virtual size_t MemoryUsage() const = 0;
+
+  // Whether several threads may add states and update values at the same
+  // time (see ConcurrentQTable).
+  virtual bool SupportsConcurrentUpdates() const { return false; }
+
+  // Removes every state and value.
+  virtual void Clear() = 0;
+
+  // Convenience accessor for callers that only hold a key: returns the value
+  // of (state, action), or 0 if the state is unknown. Never modifies the
+  // table, unlike operator[] on a map.
+  double Lookup(absl::string_view state, Action action) const;
+
+  // GreedyAction over the row of state id, with a single table access for
+  // all the legal actions. An invalid id is treated as a row of zeros.
+  QGreedyAction GreedyAction(QStateId id,
+                             absl::Span<const Action> legal_actions,
+                             double min_value, Action fallback) const;
+
+  // Read-only snapshot of the current states and values, for evaluation
+  // while the table keeps being trained.
+  FrozenQTable Freeze() const;
+
+  // Writes every key, in id order, and the values as one dense array.
+  void Save(CheckpointWriter* writer) const;
+
+  // Replaces the contents of the table with a saved one, which must have the
+  // same number of actions. States get back the ids they were saved with.
+  void Load(CheckpointReader* reader);
+};
+
+// Default QTable: state keys are interned in a hash map and the action values
+// of each state are stored contiguously in a single flat array, row id holding
+// the values of actions [0, num_actions).
+class DenseQTable : public QTable {
+ public:
+  explicit DenseQTable(int num_actions);
+
+  QStateId FindState(absl::string_view state) const override;
+  QStateId AddState(absl::string_view state) override;
+  const std::string& StateKey(QStateId id) const override;
+
+  absl::Span<const double> Row(QStateId id,
+                               QRowBuffer* buffer) const override {
+    return absl::MakeConstSpan(&values_[Index(id, 0)], num_actions_);
+  }
+
+  double Value(QStateId id, Action action) const override {
+    return values_[Index(id, action)];
+  }
+  void SetValue(QStateId id, Action action, double value) override {
+    values_[Index(id, action)] = value;
+  }
+  void AddToValue(QStateId id, Action action, double delta) override {
+    values_[Index(id, action)] += delta;
+  }
+
+  int NumStates() const override { return keys_.size(); }
+  int NumActions() const override { return num_actions_; }
+
+  size_t MemoryUsage() const override;
+
+  void Clear() override;
+
+ private:
+  size_t Index(QStateId id, Action action) const {
+    SPIEL_DCHECK_LT(id, keys_.size());
+    SPIEL_DCHECK_GE(action, 0);
+    SPIEL_DCHECK_LT(action, num_actions_);
+    return static_cast<size_t>(id) * num_actions_ + action;
+  }
+
+  int num_actions_;
+
+  // Keys are owned by the deque (whose elements never move) and the index
+  // refers to them, so every key is stored exactly once.
+  std::deque<std::string> keys_;
+  size_t key_bytes_ = 0;  // Heap memory of the keys, updated by AddState.
+  absl::flat_hash_map<absl::string_view, QStateId> index_;
+  std::vector<double> values_;
+};
+
+// Immutable snapshot of a QTable, laid out for fast lookups: the keys are
+// concatenated in a single buffer, the values of every state form a dense row
+// of a single array, and keys are found through an open-addressing index of
+// ids with their hashes stored inline, so that a lookup compares a key only
+// when its 64-bit hash matches. States keep the ids of the source table.
+class FrozenQTable {
+ public:
+  explicit FrozenQTable(const QTable& table);
+
+  // Same semantics as in QTable.
+  QStateId FindState(absl::string_view state) const;
+  absl::string_view StateKey(QStateId id) const;
+  absl::Span<const double> Row(QStateId id) const {
+    SPIEL_DCHECK_LT(id, NumStates());
+    return absl::MakeConstSpan(&values_[static_cast<size_t>(id) * num_actions_],
+                               num_actions_);
+  }
+  double Value(QStateId id, Action action) const { return Row(id)[action]; }
+  QGreedyAction GreedyAction(QStateId id,
+                             absl::Span<const Action> legal_actions,
+                             double min_value, Action fallback) const;
+
+  int NumStates() const { return key_offsets_.size() - 1; }
+  int NumActions() const { return num_actions_; }
+
+ private:
+  struct Slot {
+    uint64_t hash;
+    QStateId id;  // kInvalidQStateId if the slot is empty.
+  };
+
+  int num_actions_;
+  std::string key_data_;
+  std::vector<size_t> key_offsets_;  // Key of id in [offsets[id], offsets[id+1]).
+  std::vector<double> values_;
+  std::vector<Slot> slots_;          // Power-of-two size, at most half full.
+};
+
+// Sparse eligibility traces of Watkins's Q(lambda): only the state-action
+// pairs with a trace larger than a threshold (in absolute value) are stored,
+// so that a step costs O(number of live traces) instead of O(|Q-table|).
+class EligibilityTraces {
+ public:
+  // Traces whose absolute value falls to threshold or below are dropped. A
+  // threshold of 0 only drops traces that became exactly 0.
+  explicit EligibilityTraces(double threshold = 0);
+
+  // Adds amount to the trace of (id, action).
+  void Accumulate(QStateId id, Action action, double amount);
+
+  // Adds step * trace to the value of every traced pair, then multiplies
+  // every trace by decay, dropping the ones that become negligible. A decay
+  // of 0 clears every trace after the update.
+  void UpdateAndDecay(QTable* values, double step, double decay);
+
+  // Removes every trace, in O(number of live traces).
+  void Clear();
+
+  void Save(CheckpointWriter* writer) const;
+  void Load(CheckpointReader* reader);
+
+  int Size() const { return entries_.size(); }
+  double threshold() const { return threshold_; }
+
+ private:
+  struct Entry {
+    QStateId id;
+    Action action;
+    double trace;
+  };
+
+  void Remove(int position);
+
+  double threshold_;
+  // Live traces, in no particular order, and the position of each pair in
+  // entries_.
+  std::vector<Entry> entries_;
+  absl::flat_hash_map<std::pair<QStateId, Action>, int> positions_;
+};
+
+}  // namespace algorithms
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_ALGORITHMS_Q_TABLE_H_
@@ -0,0 +1,151 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/algorithms/sharded_q_table.h"
+
+#include "open_spiel/abseil-cpp/absl/hash/hash.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+ShardedQTable::Chunk::Chunk(int num_actions)
+    : keys(std::make_unique<std::string[]>(kChunkStates)),
+      shards(std::make_unique<uint32_t[]>(kChunkStates)),
+      values(std::make_unique<std::atomic<double>[]>(
+          static_cast<size_t>(kChunkStates) * num_actions)) {
+  for (size_t i = 0; i < static_cast<size_t>(kChunkStates) * num_actions;
+       ++i) {
+    values[i].store(0.0, std::memory_order_relaxed);
+  }
+}
+
+ShardedQTable::ShardedQTable(int num_actions, int num_shards)
+    : num_actions_(num_actions),
+      num_shards_(num_shards),
+      shards_(std::make_unique<Shard[]>(num_shards)),
+      chunks_(std::make_unique<std::atomic<Chunk*>[]>(kMaxChunks)) {
+  SPIEL_CHECK_GT(num_actions_, 0);
+  SPIEL_CHECK_GT(num_shards_, 0);
+  for (int i = 0; i < kMaxChunks; ++i) {
+    chunks_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+uint32_t ShardedQTable::ShardIndex(absl::string_view state) const {
+  // The high bits of the hash, as the index of each shard uses the low ones.
+  return (absl::Hash<absl::string_view>()(state) >> 32) % num_shards_;
+}
+
+QStateId ShardedQTable::FindState(absl::string_view state) const {
+  const Shard& shard = shards_[ShardIndex(state)];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(state);
+  return it == shard.index.end() ? kInvalidQStateId : it->second;
+}
+
+QStateId ShardedQTable::AddState(absl::string_view state) {
+  const uint32_t shard_index = ShardIndex(state);
+  Shard& shard = shards_[shard_index];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(state);
+  if (it != shard.index.end()) {
+    return it->second;
+  }
+
+  const QStateId id = num_states_.fetch_add(1, std::memory_order_acq_rel);
+  if (id >= static_cast<QStateId>(kMaxChunks) * kChunkStates) {
+    SpielFatalError(absl::StrCat("ShardedQTable is full: more than ",
+                                 kMaxChunks * kChunkStates, " states"));
+  }
+  std::atomic<Chunk*>& chunk_pointer = chunks_[id / kChunkStates];
+  Chunk* chunk = chunk_pointer.load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    std::lock_guard<std::mutex> growth_lock(growth_mutex_);
+    chunk = chunk_pointer.load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      owned_chunks_.push_back(std::make_unique<Chunk>(num_actions_));
+      chunk = owned_chunks_.back().get();
+      chunk_pointer.store(chunk, std::memory_order_release);
+    }
+  }
+  std::string& key = chunk->keys[id % kChunkStates];
+  key = std::string(state);
+  chunk->shards[id % kChunkStates] = shard_index;
+  shard.index.emplace(key, id);
+  return id;
+}
+
+const std::string& ShardedQTable::StateKey(QStateId id) const {
+  SPIEL_CHECK_LT(id, NumStates());
+  return ChunkOf(id).keys[id % kChunkStates];
+}
+
+absl::Span<const double> ShardedQTable::Row(QStateId id,
+                                            QRowBuffer* buffer) const {
+  buffer->resize(num_actions_);
+  std::lock_guard<std::mutex> lock(ShardOf(id).mutex);
+  for (Action action = 0; action < num_actions_; ++action) {
+    (*buffer)[action] = Value(id, action);
+  }
+  return absl::MakeConstSpan(*buffer);
+}
+
+void ShardedQTable::SetValue(QStateId id, Action action, double value) {
+  std::lock_guard<std::mutex> lock(ShardOf(id).mutex);
+  ValueAt(id, action).store(value, std::memory_order_relaxed);
+}
+
+void ShardedQTable::AddToValue(QStateId id, Action action, double delta) {
+  std::atomic<double>& value = ValueAt(id, action);
+  std::lock_guard<std::mutex> lock(ShardOf(id).mutex);
+  value.store(value.load(std::memory_order_relaxed) + delta,
+              std::memory_order_relaxed);
+}
+
+size_t ShardedQTable::MemoryUsage() const {
+  const size_t chunk_bytes =
+      static_cast<size_t>(kChunkStates) *
+      (sizeof(std::string) + sizeof(uint32_t) + num_actions_ * sizeof(double));
+  size_t bytes = kMaxChunks * sizeof(std::atomic<Chunk*>) +
+                 static_cast<size_t>(num_shards_) * sizeof(Shard) +
+                 owned_chunks_.size() * chunk_bytes;
+  for (int i = 0; i < num_shards_; ++i) {
+    // One control byte per slot of the flat hash map.
+    bytes += shards_[i].index.capacity() *
+             (sizeof(std::pair<absl::string_view, QStateId>) + 1);
+  }
+  const int num_states = NumStates();
+  for (QStateId id = 0; id < num_states; ++id) {
+    const std::string& key = StateKey(id);
+    if (key.capacity() > std::string().capacity()) {
+      bytes += key.capacity() + 1;  // Not stored inline.
+    }
+  }
+  return bytes;
+}
+
+void ShardedQTable::Clear() {
+  for (int i = 0; i < num_shards_; ++i) {
+    shards_[i].index.clear();
+  }
+  for (int i = 0; i < kMaxChunks; ++i) {
+    chunks_[i].store(nullptr, std::memory_order_relaxed);
+  }
+  owned_chunks_.clear();
+  num_states_.store(0, std::memory_order_release);
+}
+
+}  // namespace algorithms
+}  // namespace open_spiel
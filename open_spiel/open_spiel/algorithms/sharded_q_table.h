@@ -0,0 +1,129 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_ALGORITHMS_SHARDED_Q_TABLE_H_
+#define OPEN_SPIEL_ALGORITHMS_SHARDED_Q_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/abseil-cpp/absl/strings/string_view.h"
+#include "open_spiel/abseil-cpp/absl/types/span.h"
+#include "open_spiel/algorithms/q_table.h"
+
+namespace open_spiel {
+namespace algorithms {
+
+// QTable for concurrent training that, unlike ConcurrentQTable, grows without
+// a fixed capacity and serializes the updates of a state.
+//
+// States are spread over num_shards shards by the hash of their key. Each
+// shard has its own lock, which guards the index of its keys and the updates
+// of the values of its states, so threads only contend when they touch
+// states of the same shard. Ids are global and dense; keys and rows live in
+// fixed-size chunks that are allocated as the table grows and never move, so
+// ids, keys and rows stay valid while other threads add states. Values are
+// stored as atomic doubles: Value is a single atomic load that does not lock,
+// while Row copies the whole row under the lock of its shard, so it never
+// sees an update half applied.
+//
+// With TabularQLearningSolver::RunIterationsConcurrently in deterministic
+// mode the updates are applied by a single thread, in a fixed order, and the
+// learned values do not depend on the scheduling of the threads.
+//
+// Clear, Load and the count returned by NumStates while insertions are in
+// progress are not thread-safe; call them when no other thread uses the
+// table.
+class ShardedQTable : public QTable {
+ public:
+  ShardedQTable(int num_actions, int num_shards);
+
+  QStateId FindState(absl::string_view state) const override;
+  QStateId AddState(absl::string_view state) override;
+  const std::string& StateKey(QStateId id) const override;
+
+  absl::Span<const double> Row(QStateId id,
+                               QRowBuffer* buffer) const override;
+
+  double Value(QStateId id, Action action) const override {
+    return ValueAt(id, action).load(std::memory_order_relaxed);
+  }
+  void SetValue(QStateId id, Action action, double value) override;
+  void AddToValue(QStateId id, Action action, double delta) override;
+
+  int NumStates() const override {
+    return num_states_.load(std::memory_order_acquire);
+  }
+  int NumActions() const override { return num_actions_; }
+  int NumShards() const { return num_shards_; }
+
+  size_t MemoryUsage() const override;
+
+  bool SupportsConcurrentUpdates() const override { return true; }
+
+  void Clear() override;
+
+ private:
+  static constexpr int kChunkStates = 1 << 12;
+  static constexpr int kMaxChunks = 1 << 16;
+
+  struct Chunk {
+    explicit Chunk(int num_actions);
+
+    std::unique_ptr<std::string[]> keys;
+    std::unique_ptr<uint32_t[]> shards;  // Shard of every state.
+    std::unique_ptr<std::atomic<double>[]> values;
+  };
+
+  // Aligned to a cache line, so that threads locking different shards do
+  // not share one.
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;
+    absl::flat_hash_map<absl::string_view, QStateId> index;
+  };
+
+  Chunk& ChunkOf(QStateId id) const {
+    SPIEL_DCHECK_LT(id, num_states_.load(std::memory_order_relaxed));
+    return *chunks_[id / kChunkStates].load(std::memory_order_acquire);
+  }
+  std::atomic<double>& ValueAt(QStateId id, Action action) const {
+    SPIEL_DCHECK_GE(action, 0);
+    SPIEL_DCHECK_LT(action, num_actions_);
+    return ChunkOf(id).values[static_cast<size_t>(id % kChunkStates) *
+                                  num_actions_ +
+                              action];
+  }
+  Shard& ShardOf(QStateId id) const {
+    return shards_[ChunkOf(id).shards[id % kChunkStates]];
+  }
+  uint32_t ShardIndex(absl::string_view state) const;
+
+  const int num_actions_;
+  const int num_shards_;
+  std::atomic<int> num_states_{0};
+  std::unique_ptr<Shard[]> shards_;
+  std::mutex growth_mutex_;  // Guards the allocation of new chunks.
+  std::unique_ptr<std::atomic<Chunk*>[]> chunks_;
+  std::vector<std::unique_ptr<Chunk>> owned_chunks_;
+};
+
+}  // namespace algorithms
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_ALGORITHMS_SHARDED_Q_TABLE_H_
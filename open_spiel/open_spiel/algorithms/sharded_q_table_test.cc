@@ -0,0 +1,164 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/algorithms/sharded_q_table.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/algorithms/concurrent_q_table.h"
+#include "open_spiel/algorithms/tabular_q_learning.h"
+#include "open_spiel/game_transforms/turn_based_simultaneous_game.h"
+#include "open_spiel/spiel.h"
+#include "open_spiel/spiel_utils.h"
+#include "open_spiel/utils/thread_pool.h"
+#include "bandits/eps_greedy.h"
+
+namespace open_spiel {
+namespace algorithms {
+namespace {
+
+constexpr int kNumThreads = 4;
+
+// Runs fn(thread) on kNumThreads threads, released at the same time so that
+// they race as much as possible.
+template <typename Fn>
+void RunOnThreads(const Fn& fn) {
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&go, &fn, t] {
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      fn(t);
+    });
+  }
+  go.store(true, std::memory_order_release);
+  for (std::thread& thread : threads) thread.join();
+}
+
+void TestRacingAddStateGivesOneId() {
+  // More states than fit in a chunk, so that chunks are allocated while
+  // other threads insert.
+  constexpr int kNumKeys = 20000;
+  ShardedQTable table(2, 16);
+  std::vector<std::vector<QStateId>> ids(kNumThreads,
+                                         std::vector<QStateId>(kNumKeys));
+  RunOnThreads([&](int t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      const int key = t % 2 == 0 ? i : kNumKeys - 1 - i;
+      ids[t][key] = table.AddState(absl::StrCat("state ", key));
+    }
+  });
+
+  SPIEL_CHECK_EQ(table.NumStates(), kNumKeys);
+  for (int key = 0; key < kNumKeys; ++key) {
+    const QStateId id = ids[0][key];
+    for (int t = 1; t < kNumThreads; ++t) SPIEL_CHECK_EQ(ids[t][key], id);
+    SPIEL_CHECK_EQ(table.StateKey(id), absl::StrCat("state ", key));
+    SPIEL_CHECK_EQ(table.FindState(absl::StrCat("state ", key)), id);
+  }
+}
+
+void TestConcurrentAddToValueLosesNoUpdate() {
+  constexpr int kNumKeys = 64;
+  constexpr int kUpdatesPerThread = 200000;
+  ShardedQTable table(3, 4);
+  RunOnThreads([&](int t) {
+    for (int i = 0; i < kUpdatesPerThread; ++i) {
+      const QStateId id = table.AddState(absl::StrCat(i % kNumKeys));
+      table.AddToValue(id, i % 3, 1.0);
+    }
+  });
+
+  double total = 0;
+  QRowBuffer buffer;
+  for (QStateId id = 0; id < table.NumStates(); ++id) {
+    for (double value : table.Row(id, &buffer)) total += value;
+  }
+  // Sums of integers are exact in double.
+  SPIEL_CHECK_EQ(total, static_cast<double>(kNumThreads) * kUpdatesPerThread);
+}
+
+// Action values of every state, by key, so that tables whose states got
+// different ids can be compared.
+std::map<std::string, std::vector<double>> ValuesByKey(const QTable& table) {
+  std::map<std::string, std::vector<double>> values;
+  QRowBuffer buffer;
+  for (QStateId id = 0; id < table.NumStates(); ++id) {
+    absl::Span<const double> row = table.Row(id, &buffer);
+    values[table.StateKey(id)].assign(row.begin(), row.end());
+  }
+  return values;
+}
+
+// Trains on a maze with random moves, which every initial state draws from
+// the random stream of the game, in deterministic mode.
+std::map<std::string, std::vector<double>> TrainDeterministically(
+    std::unique_ptr<QTable> table) {
+  std::shared_ptr<const Game> game = LoadGameAsTurnBased(
+      "pathfinding", {{"grid", GameParameter(std::string("A.*..**\n"
+                                                         "..*....\n"
+                                                         "....*a.\n"))},
+                      {"horizon", GameParameter(30)},
+                      {"random_move_chance", GameParameter(0.3)},
+                      {"rng_seed", GameParameter(42)}});
+  policies::EpsilonGreedyPolicy policy(0.2);
+  policy.SetSeed(7);
+  TabularQLearningSolver solver(game, 0.1, 0.99, &policy, identity_function,
+                                std::move(table));
+  solver.SetSeed(1);
+  ThreadPool pool(kNumThreads);
+  solver.RunIterationsConcurrently(401, &pool, /*deterministic=*/true);
+  solver.RunIterationsConcurrently(200, &pool, /*deterministic=*/true);
+  return ValuesByKey(solver.GetQValueTable());
+}
+
+void TestDeterministicTrainingIsReproducible() {
+  const int num_actions = LoadGameAsTurnBased("pathfinding")
+                              ->NumDistinctActions();
+  const std::map<std::string, std::vector<double>> expected =
+      TrainDeterministically(std::make_unique<ShardedQTable>(num_actions, 16));
+
+  bool learned = false;
+  for (const auto& [key, row] : expected) {
+    for (double value : row) learned = learned || value != 0;
+  }
+  SPIEL_CHECK_TRUE(learned);
+
+  for (int run = 0; run < 3; ++run) {
+    SPIEL_CHECK_TRUE(TrainDeterministically(std::make_unique<ShardedQTable>(
+                         num_actions, 16)) == expected);
+  }
+  for (int num_shards : {1, 3, 64}) {
+    SPIEL_CHECK_TRUE(TrainDeterministically(std::make_unique<ShardedQTable>(
+                         num_actions, num_shards)) == expected);
+  }
+  SPIEL_CHECK_TRUE(TrainDeterministically(std::make_unique<ConcurrentQTable>(
+                       num_actions, 1000)) == expected);
+}
+
+}  // namespace
+}  // namespace algorithms
+}  // namespace open_spiel
+
+int main(int argc, char** argv) {
+  open_spiel::algorithms::TestRacingAddStateGivesOneId();
+  open_spiel::algorithms::TestConcurrentAddToValueLosesNoUpdate();
+  open_spiel::algorithms::TestDeterministicTrainingIsReproducible();
+}
@@ -15,9 +15,12 @@
 #include "open_spiel/algorithms/tabular_q_learning.h"
 
 #include <algorithm>
+#include <chrono>
 #include <random>
 #include <typeinfo>
 
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/utils/thread_pool.h"
 #include "bandits/eps_greedy.h"
 
 namespace open_spiel {
@@ -27,64 +30,86 @@ using policies::GenericPolicy;
 using policies::EpsilonGreedyPolicy;
 using std::vector;
 
+namespace {
+int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
 std::string identity_function (const std::string state) {
   return state;
 }
 
 
 Action getBestActionFunction (const State& state, void* data_pointer) {
-  auto data_cast = *((std::tuple<absl::flat_hash_map<std::pair<std::string, Action>, double>*, double, policies::StateAbstractionFunction>*)data_pointer);
+  auto data_cast = *((std::tuple<QTable*, double, policies::StateAbstractionFunction>*)data_pointer);
   auto values_ = std::get<0>(data_cast);
   auto min_utility = std::get<1>(data_cast);
   auto abstraction_func = std::get<2>(data_cast);
 
   vector<Action> legal_actions = state.LegalActions();
   const auto state_str = abstraction_func(state.ToString());
+  const QStateId state_id = values_->FindState(state_str);
 
+  return values_->GreedyAction(state_id, legal_actions, min_utility,
+                               legal_actions[0]).action;
+}
 
-  Action best_action = legal_actions[0];
-  double value = min_utility;
-  for (const Action& action : legal_actions) {
-    double q_val = (*values_)[{state_str, action}];
-    if (q_val >= value) {
-      value = q_val;
-      best_action = action;
-    }
+void TabularQLearningSolver::MakeStepContext(const State& state,
+                                             StepContext* context) {
+  context->state = &state;
+  if (key_func_) {
+    context->key = key_func_(state);
+    context->state_string_valid = false;
+  } else {
+    context->state_string = state.ToString();
+    context->state_string_valid = true;
+    context->key = abstraction_func(context->state_string);
+  }
+  const int num_states = stats_enabled_ ? values_->NumStates() : 0;
+  context->state_id = values_->AddState(context->key);
+  if (stats_enabled_) {
+    ++stats_.key_lookups;
+    stats_.new_states += values_->NumStates() - num_states;
   }
-  return best_action;
+  Lap(QLearningStats::kStateKey);
+  context->legal_actions = state.LegalActions();
+  Lap(QLearningStats::kEnvironment);
 }
 
-Action TabularQLearningSolver::GetBestAction(const State& state,
-                                             double min_utility) {
-  vector<Action> legal_actions = state.LegalActions();
+void TabularQLearningSolver::RecordLap(QLearningStats::Section section) {
+  const int64_t now = NowNanos();
+  stats_.section_ns[section] += now - lap_ns_;
+  lap_ns_ = now;
+}
+
+QGreedyAction TabularQLearningSolver::GetBestActionAndValue(
+    const StepContext& context, double min_utility) {
+  const vector<Action>& legal_actions = context.legal_actions;
   SPIEL_CHECK_GT(legal_actions.size(), 0);
-  const auto state_str = abstraction_func(state.ToString());
 
-  Action best_action = legal_actions[0];
-  double value = min_utility;
-  for (const Action& action : legal_actions) {
-    double q_val = values_[{state_str, action}];
-    if (q_val >= value) {
-      value = q_val;
-      best_action = action;
-    }
-  }
-  return best_action;
+  // The whole row of the state is read with one probe, instead of one lookup
+  // per legal action.
+  return values_->GreedyAction(context.state_id, legal_actions, min_utility,
+                               legal_actions[0]);
 }
 
-double TabularQLearningSolver::GetBestActionValue(const State& state,
+Action TabularQLearningSolver::GetBestAction(const StepContext& context,
+                                             double min_utility) {
+  return GetBestActionAndValue(context, min_utility).action;
+}
+
+double TabularQLearningSolver::GetBestActionValue(const StepContext& context,
                                                   double min_utility) {
-  if (state.IsTerminal()) {
-    // q(s,a) is 0 when s is terminal.
-    return 0;
-  }
-  return values_[{abstraction_func(state.ToString()), GetBestAction(state, min_utility)}];
+  return GetBestActionAndValue(context, min_utility).value;
 }
 
 std::pair<Action, bool>
 TabularQLearningSolver::SampleActionFromEpsilonGreedyPolicy(
-    const State& state, double min_utility) {
-  return std::make_pair(policy_->action_selection(state), true);
+    const StepContext& context, double min_utility) {
+  return std::make_pair(policy_->action_selection(context), true);
 }
 
 void TabularQLearningSolver::SampleUntilNextStateOrTerminal(State* state) {
@@ -101,10 +126,12 @@ TabularQLearningSolver::TabularQLearningSolver(std::shared_ptr<const Game> game,
     learning_rate_(kDefaultLearningRate),
     discount_factor_(kDefaultDiscountFactor),
     lambda_(kDefaultLambda),
+    values_(std::make_unique<DenseQTable>(game->NumDistinctActions())),
     abstraction_func(func) {
 
-        policy_ = new EpsilonGreedyPolicy(epsilon_);
-        policy_->setQTableStructure(&values_, discount_factor_, learning_rate_, abstraction_func);
+        owned_policy_ = std::make_unique<EpsilonGreedyPolicy>(epsilon_);
+        policy_ = owned_policy_.get();
+        policy_->setQTableStructure(values_.get(), discount_factor_, learning_rate_, abstraction_func);
 
         SPIEL_CHECK_LE(lambda_, 1);
         SPIEL_CHECK_GE(lambda_, 0);
@@ -131,6 +158,7 @@ TabularQLearningSolver::TabularQLearningSolver(
       learning_rate_(learning_rate),
       discount_factor_(discount_factor),
       lambda_(lambda),
+      values_(std::make_unique<DenseQTable>(game->NumDistinctActions())),
       abstraction_func(func){
 
           SPIEL_CHECK_LE(lambda_, 1);
@@ -149,21 +177,37 @@ TabularQLearningSolver::TabularQLearningSolver(
         // SPIEL_CHECK_EQ(game_->GetType().information,
                       //  GameType::Information::kPerfectInformation);
 
-        policy_ = new EpsilonGreedyPolicy(epsilon_);
-        policy_->setQTableStructure(&values_, discount_factor_, learning_rate_, abstraction_func);
+        owned_policy_ = std::make_unique<EpsilonGreedyPolicy>(epsilon_);
+        policy_ = owned_policy_.get();
+        policy_->setQTableStructure(values_.get(), discount_factor_, learning_rate_, abstraction_func);
   }
 
   TabularQLearningSolver::TabularQLearningSolver(
-    std::shared_ptr<const Game> game, double learning_rate, double discount_factor, GenericPolicy* policy, StateAbstractionFunction func)  : game_(game),
+    std::shared_ptr<const Game> game, double learning_rate, double discount_factor, GenericPolicy* policy, StateAbstractionFunction func)
+    : TabularQLearningSolver(game, learning_rate, discount_factor, policy, func,
+                             std::make_unique<DenseQTable>(game->NumDistinctActions())) {}
+
+  TabularQLearningSolver::TabularQLearningSolver(
+    std::shared_ptr<const Game> game, double learning_rate, double discount_factor, std::unique_ptr<GenericPolicy> policy, StateAbstractionFunction func)
+    : TabularQLearningSolver(game, learning_rate, discount_factor, policy.get(), func) {
+        owned_policy_ = std::move(policy);
+  }
+
+  TabularQLearningSolver::TabularQLearningSolver(
+    std::shared_ptr<const Game> game, double learning_rate, double discount_factor, GenericPolicy* policy, StateAbstractionFunction func,
+    std::unique_ptr<QTable> table)  : game_(game),
       depth_limit_(kDefaultDepthLimit),
       epsilon_(kDefaultEpsilon),
       learning_rate_(learning_rate),
       discount_factor_(discount_factor),
       lambda_(kDefaultLambda),
       policy_(policy),
+      values_(std::move(table)),
       abstraction_func(func){
 
-        policy_->setQTableStructure(&values_, discount_factor_, learning_rate_, abstraction_func);
+        SPIEL_CHECK_TRUE(values_ != nullptr);
+        SPIEL_CHECK_GE(values_->NumActions(), game_->NumDistinctActions());
+        policy_->setQTableStructure(values_.get(), discount_factor_, learning_rate_, abstraction_func);
 
         SPIEL_CHECK_LE(lambda_, 1);
         SPIEL_CHECK_GE(lambda_, 0);
@@ -189,9 +233,10 @@ TabularQLearningSolver::TabularQLearningSolver(
     discount_factor_(kDefaultDiscountFactor),
     lambda_(kDefaultLambda),
     policy_(policy),
+    values_(std::make_unique<DenseQTable>(game->NumDistinctActions())),
     abstraction_func(func) {
 
-        policy_->setQTableStructure(&values_, discount_factor_, learning_rate_, abstraction_func);
+        policy_->setQTableStructure(values_.get(), discount_factor_, learning_rate_, abstraction_func);
 
         SPIEL_CHECK_LE(lambda_, 1);
         SPIEL_CHECK_GE(lambda_, 0);
@@ -210,75 +255,378 @@ TabularQLearningSolver::TabularQLearningSolver(
 
 }
 
-const absl::flat_hash_map<std::pair<std::string, Action>, double>&
-TabularQLearningSolver::GetQValueTable() const {
-  return values_;
+TabularQLearningSolver::TabularQLearningSolver(
+    const TabularQLearningSolver& parent, std::unique_ptr<GenericPolicy> policy)
+    : game_(parent.game_),
+      depth_limit_(parent.depth_limit_),
+      epsilon_(parent.epsilon_),
+      learning_rate_(parent.learning_rate_),
+      discount_factor_(parent.discount_factor_),
+      lambda_(parent.lambda_),
+      policy_(policy.get()),
+      owned_policy_(std::move(policy)),
+      values_(parent.values_),
+      abstraction_func(parent.abstraction_func),
+      key_func_(parent.key_func_) {
+  policy_->setQTableStructure(values_.get(), discount_factor_, learning_rate_,
+                              abstraction_func);
+}
+
+void TabularQLearningSolver::Save(CheckpointWriter* writer) const {
+  writer->WriteString(game_->GetType().short_name);
+  writer->WriteString(policy_->toString());
+  writer->WriteEngine(rng_);
+  values_->Save(writer);
+  eligibility_traces_.Save(writer);
+  policy_->SaveState(writer);
+}
+
+void TabularQLearningSolver::Load(CheckpointReader* reader) {
+  const std::string game_name = reader->ReadString();
+  if (game_name != game_->GetType().short_name) {
+    SpielFatalError(absl::StrCat("Checkpoint of game ", game_name,
+                                 ", solver of ", game_->GetType().short_name));
+  }
+  const std::string policy_name = reader->ReadString();
+  if (policy_name != policy_->toString()) {
+    SpielFatalError(absl::StrCat("Checkpoint of policy ", policy_name,
+                                 ", solver with ", policy_->toString()));
+  }
+  reader->ReadEngine(&rng_);
+  values_->Load(reader);
+  eligibility_traces_.Load(reader);
+  policy_->LoadState(reader);
+}
+
+void TabularQLearningSolver::SaveCheckpoint(const std::string& path) const {
+  CheckpointWriter writer;
+  Save(&writer);
+  writer.Save(path);
+}
+
+void TabularQLearningSolver::LoadCheckpoint(const std::string& path) {
+  CheckpointReader reader(path);
+  Load(&reader);
+  SPIEL_CHECK_TRUE(reader.AtEnd());
+}
+
+const QTable& TabularQLearningSolver::GetQValueTable() const {
+  return *values_;
 }
 
 policies::StateAbstractionFunction TabularQLearningSolver::GetAbstractionFunction() const {
   return abstraction_func;
 }
 
-void TabularQLearningSolver::RunIteration() {
+QLearningStats TabularQLearningSolver::GetStats() const {
+  QLearningStats stats = stats_;
+  stats.table_states = values_->NumStates();
+  stats.table_bytes = values_->MemoryUsage();
+  stats.trace_entries = eligibility_traces_.Size();
+  stats.policy_bytes = policy_->MemoryUsage();
+  return stats;
+}
+
+void TabularQLearningSolver::SetStateKeyFunction(StateKeyFunction func) {
+  SPIEL_CHECK_EQ(values_->NumStates(), 0);
+  key_func_ = func;
+}
+
+StateKeyFunction TabularQLearningSolver::GetStateKeyFunction() const {
+  return key_func_ ? key_func_
+                   : policies::MakeStateKeyFunction(abstraction_func);
+}
+
+void TabularQLearningSolver::RunIteration() { RunEpisode(nullptr); }
+
+void TabularQLearningSolver::RunEpisode(
+    std::unique_ptr<State> initial_state) {
 
   const double min_utility = game_->MinUtility();
+  const int64_t start_ns = stats_enabled_ ? NowNanos() : 0;
+  lap_ns_ = start_ns;
 
   // Choose start state
-  std::unique_ptr<State> curr_state = game_->NewInitialState();
+  std::unique_ptr<State> curr_state = initial_state != nullptr
+                                          ? std::move(initial_state)
+                                          : game_->NewInitialState();
   SampleUntilNextStateOrTerminal(curr_state.get());
+  Lap(QLearningStats::kEnvironment);
+
+  // The context of the next state of a step is reused as the context of the
+  // current state of the following step, so each state is keyed only once.
+  StepContext curr_context;
+  StepContext next_context;
+  if (!curr_state->IsTerminal()) {
+    MakeStepContext(*curr_state, &curr_context);
+  }
 
   while (!curr_state->IsTerminal()) {
     const Player player = curr_state->CurrentPlayer();
 
     // Sample action from the state using an epsilon-greedy policy
     auto [curr_action, chosen_uniformly] =
-        SampleActionFromEpsilonGreedyPolicy(*curr_state, min_utility);
+        SampleActionFromEpsilonGreedyPolicy(curr_context, min_utility);
+    Lap(QLearningStats::kSelection);
 
     std::unique_ptr<State> next_state = curr_state->Child(curr_action);
     SampleUntilNextStateOrTerminal(next_state.get());
 
     const double reward = next_state->Rewards()[player];
+    Lap(QLearningStats::kEnvironment);
+
+    // q(s,a) is 0 when s is terminal.
+    double next_best_value = 0;
+    if (!next_state->IsTerminal()) {
+      MakeStepContext(*next_state, &next_context);
+      next_best_value = GetBestActionValue(next_context, min_utility);
+    }
     // Next q-value in perspective of player to play at curr_state (important
     // note: exploits property of two-player zero-sum)
     const double next_q_value =
-        (player != next_state->CurrentPlayer() ? -1 : 1) *
-        GetBestActionValue(*next_state, min_utility);
+        (player != next_state->CurrentPlayer() ? -1 : 1) * next_best_value;
 
     // Update the q value
-    std::string key = abstraction_func(curr_state->ToString());
+    const QStateId key_id = curr_context.state_id;
 
     double new_q_value = reward + discount_factor_ * next_q_value;
 
-    double prev_q_val = values_[{key, curr_action}];
-    if (lambda_ == 0) {
+    double prev_q_val = values_->Value(key_id, curr_action);
+    if (lambda_ == 0 && update_buffer_ != nullptr) {
+      update_buffer_->push_back({key_id, curr_action, new_q_value});
+    } else if (lambda_ == 0) {
       // If lambda_ is equal to zero run Q-learning as usual.
       // It's not necessary to update eligibility traces.
-      values_[{key, curr_action}] +=
-          learning_rate_ * (new_q_value - prev_q_val);
+      values_->AddToValue(key_id, curr_action,
+                          learning_rate_ * (new_q_value - prev_q_val));
     } else {
       double lambda =
           player != next_state->CurrentPlayer() ? -lambda_ : lambda_;
-      eligibility_traces_[{key, curr_action}] += 1;
-
-      for (const auto& q_cell : values_) {
-        std::string state = q_cell.first.first;
-        Action action = q_cell.first.second;
-
-        values_[{state, action}] += learning_rate_ *
-                                    (new_q_value - prev_q_val) *
-                                    eligibility_traces_[{state, action}];
-        if (chosen_uniformly) {
-          eligibility_traces_[{state, action}] = 0;
-        } else {
-          eligibility_traces_[{state, action}] *= discount_factor_ * lambda;
+      eligibility_traces_.Accumulate(key_id, curr_action, 1);
+
+      // Only the pairs with a live trace are visited; an exploratory action
+      // resets all of them.
+      eligibility_traces_.UpdateAndDecay(
+          values_.get(), learning_rate_ * (new_q_value - prev_q_val),
+          chosen_uniformly ? 0 : discount_factor_ * lambda);
+    }
+
+    policy_->reward_update(curr_context, curr_action, reward,
+                           next_state->IsTerminal() ? nullptr : &next_context);
+    Lap(QLearningStats::kUpdate);
+    if (stats_enabled_) ++stats_.steps;
+
+    curr_state = std::move(next_state);
+    std::swap(curr_context, next_context);
+  }
+
+  if (stats_enabled_) {
+    ++stats_.episodes;
+    stats_.total_ns += NowNanos() - start_ns;
+  }
+}
+
+void TabularQLearningSolver::RunIterationsConcurrently(int n, ThreadPool* pool,
+                                                       bool deterministic) {
+  SPIEL_CHECK_GE(n, 0);
+  SPIEL_CHECK_TRUE(pool != nullptr);
+  const int n_threads = pool->NumThreads();
+  SPIEL_CHECK_TRUE(values_->SupportsConcurrentUpdates());
+  SPIEL_CHECK_EQ(lambda_, 0);
+
+  while (actors_.size() + 1 < n_threads) {
+    std::unique_ptr<GenericPolicy> policy = policy_->Clone();
+    policy->SetSeed(rng_());
+    actors_.push_back(std::unique_ptr<TabularQLearningSolver>(
+        new TabularQLearningSolver(*this, std::move(policy))));
+  }
+  for (int i = 0; i + 1 < n_threads; ++i) {
+    actors_[i]->SetSeed(rng_());
+    actors_[i]->EnableStats(stats_enabled_);
+  }
+
+  const int64_t total_ns = stats_.total_ns;
+  const int64_t new_states = stats_.new_states;
+  const int num_states = values_->NumStates();
+  const int64_t start_ns = stats_enabled_ ? NowNanos() : 0;
+  auto actor = [this](int i) {
+    return i == 0 ? this : actors_[i - 1].get();
+  };
+  if (!deterministic) {
+    pool->ParallelFor(n_threads, [&](int i, int worker) {
+      const int num_episodes = n / n_threads + (i < n % n_threads ? 1 : 0);
+      for (int episode = 0; episode < num_episodes; ++episode) {
+        actor(i)->RunIteration();
+      }
+    });
+  } else {
+    std::vector<std::vector<BufferedUpdate>> buffers(n_threads);
+    std::vector<std::unique_ptr<State>> initial_states(n_threads);
+    for (int i = 0; i < n_threads; ++i) {
+      actor(i)->update_buffer_ = &buffers[i];
+    }
+    for (int first = 0; first < n; first += n_threads) {
+      const int num_episodes = std::min(n_threads, n - first);
+      for (int i = 0; i < num_episodes; ++i) {
+        initial_states[i] = game_->NewInitialState();
+      }
+      pool->ParallelFor(num_episodes, [&](int i, int worker) {
+        actor(i)->RunEpisode(std::move(initial_states[i]));
+      });
+      const int64_t apply_ns = stats_enabled_ ? NowNanos() : 0;
+      for (int i = 0; i < num_episodes; ++i) {
+        for (const BufferedUpdate& update : buffers[i]) {
+          values_->AddToValue(
+              update.id, update.action,
+              learning_rate_ *
+                  (update.target - values_->Value(update.id, update.action)));
         }
+        buffers[i].clear();
+      }
+      if (stats_enabled_) {
+        stats_.section_ns[QLearningStats::kUpdate] += NowNanos() - apply_ns;
       }
     }
+    for (int i = 0; i < n_threads; ++i) {
+      actor(i)->update_buffer_ = nullptr;
+    }
+  }
 
-    policy_->reward_update(*(curr_state.get()), curr_action, reward);
+  if (stats_enabled_) {
+    // Counters and section times add up over the threads; the total is the
+    // wall time of the call.
+    for (int i = 0; i + 1 < n_threads; ++i) {
+      const QLearningStats& actor_stats = actors_[i]->stats_;
+      stats_.episodes += actor_stats.episodes;
+      stats_.steps += actor_stats.steps;
+      stats_.key_lookups += actor_stats.key_lookups;
+      for (int section = 0; section < QLearningStats::kNumSections;
+           ++section) {
+        stats_.section_ns[section] += actor_stats.section_ns[section];
+      }
+      actors_[i]->ResetStats();
+    }
+    // Each thread also sees the states added by the others.
+    stats_.new_states = new_states + values_->NumStates() - num_states;
+    stats_.total_ns = total_ns + NowNanos() - start_ns;
+  }
+}
 
-    curr_state = std::move(next_state);
+bool TabularQLearningSolver::StartBatchEpisode(int n, int* num_started,
+                                               BatchEpisode* episode) {
+  while (*num_started < n) {
+    ++*num_started;
+    if (stats_enabled_) ++stats_.episodes;
+    episode->state = game_->NewInitialState();
+    SampleUntilNextStateOrTerminal(episode->state.get());
+    Lap(QLearningStats::kEnvironment);
+    if (!episode->state->IsTerminal()) {
+      MakeStepContext(*episode->state, &episode->context);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TabularQLearningSolver::RunIterations(int n, int batch_size) {
+  SPIEL_CHECK_GE(n, 0);
+  SPIEL_CHECK_GT(batch_size, 0);
+
+  if (batch_size == 1 || lambda_ != 0) {
+    for (int i = 0; i < n; ++i) {
+      RunIteration();
+    }
+    return;
+  }
+
+  const double min_utility = game_->MinUtility();
+  const int64_t start_ns = stats_enabled_ ? NowNanos() : 0;
+  lap_ns_ = start_ns;
+
+  int num_started = 0;
+  std::vector<BatchEpisode> episodes;
+  episodes.reserve(batch_size);
+  while (episodes.size() < batch_size) {
+    BatchEpisode episode;
+    if (!StartBatchEpisode(n, &num_started, &episode)) break;
+    episodes.push_back(std::move(episode));
   }
+
+  std::vector<const StepContext*> contexts;
+  std::vector<Action> actions;
+  std::vector<Player> players;
+  std::vector<double> rewards;
+  std::vector<double> targets;
+
+  while (!episodes.empty()) {
+    const int num_episodes = episodes.size();
+    contexts.resize(num_episodes);
+    actions.resize(num_episodes);
+    players.resize(num_episodes);
+    rewards.resize(num_episodes);
+    targets.resize(num_episodes);
+
+    for (int i = 0; i < num_episodes; ++i) {
+      contexts[i] = &episodes[i].context;
+      players[i] = episodes[i].state->CurrentPlayer();
+    }
+    policy_->action_selection_batch(contexts, absl::MakeSpan(actions));
+    Lap(QLearningStats::kSelection);
+
+    // Step the whole batch and compute the TD targets before any update, so
+    // that every target of a step sees the same action values.
+    for (int i = 0; i < num_episodes; ++i) {
+      BatchEpisode& episode = episodes[i];
+      episode.next_state = episode.state->Child(actions[i]);
+      SampleUntilNextStateOrTerminal(episode.next_state.get());
+      rewards[i] = episode.next_state->Rewards()[players[i]];
+      Lap(QLearningStats::kEnvironment);
+
+      double next_best_value = 0;
+      if (!episode.next_state->IsTerminal()) {
+        MakeStepContext(*episode.next_state, &episode.next_context);
+        next_best_value = GetBestActionValue(episode.next_context, min_utility);
+      }
+      const double next_q_value =
+          (players[i] != episode.next_state->CurrentPlayer() ? -1 : 1) *
+          next_best_value;
+      targets[i] = rewards[i] + discount_factor_ * next_q_value;
+      Lap(QLearningStats::kUpdate);
+    }
+
+    for (int i = 0; i < num_episodes; ++i) {
+      BatchEpisode& episode = episodes[i];
+      const QStateId key_id = episode.context.state_id;
+      values_->AddToValue(
+          key_id, actions[i],
+          learning_rate_ * (targets[i] - values_->Value(key_id, actions[i])));
+      policy_->reward_update(
+          episode.context, actions[i], rewards[i],
+          episode.next_state->IsTerminal() ? nullptr : &episode.next_context);
+    }
+    Lap(QLearningStats::kUpdate);
+    if (stats_enabled_) stats_.steps += num_episodes;
+
+    // Advance the batch, replacing the finished episodes.
+    int num_kept = 0;
+    for (int i = 0; i < num_episodes; ++i) {
+      BatchEpisode& episode = episodes[i];
+      bool keep = true;
+      if (episode.next_state->IsTerminal()) {
+        keep = StartBatchEpisode(n, &num_started, &episode);
+      } else {
+        episode.state = std::move(episode.next_state);
+        std::swap(episode.context, episode.next_context);
+      }
+      if (keep) {
+        if (num_kept != i) episodes[num_kept] = std::move(episode);
+        ++num_kept;
+      }
+    }
+    episodes.erase(episodes.begin() + num_kept, episodes.end());
+  }
+
+  if (stats_enabled_) stats_.total_ns += NowNanos() - start_ns;
 }
 }  // namespace algorithms
 }  // namespace open_spiel
@@ -19,7 +19,10 @@
 #include "open_spiel/abseil-cpp/absl/random/distributions.h"
 #include "open_spiel/abseil-cpp/absl/random/random.h"
 #include "open_spiel/algorithms/get_all_states.h"
+#include "open_spiel/algorithms/q_learning_stats.h"
+#include "open_spiel/algorithms/q_table.h"
 #include "open_spiel/spiel.h"
+#include "open_spiel/utils/thread_pool.h"
 #include "bandits/generic_policy.h"
 
 #include <random>
@@ -27,6 +30,8 @@
 
 using policies::GenericPolicy;
 using policies::StateAbstractionFunction;
+using policies::StateKeyFunction;
+using policies::StepContext;
 
 namespace open_spiel {
 namespace algorithms {
@@ -59,6 +64,7 @@ class TabularQLearningSolver {
   static inline constexpr double kDefaultLearningRate = 0.01;
   static inline constexpr double kDefaultDiscountFactor = 0.99;
   static inline constexpr double kDefaultLambda = 0;
+  static inline constexpr double kDefaultTraceThreshold = 1e-10;
 
  public:
   TabularQLearningSolver(std::shared_ptr<const Game> game, StateAbstractionFunction func = identity_function);
@@ -72,32 +78,170 @@ class TabularQLearningSolver {
   TabularQLearningSolver(
     std::shared_ptr<const Game> game, double learning_rate, double discount_factor, GenericPolicy* policy, StateAbstractionFunction func);
 
+  // Same as above, but stores the action values in the given table instead of
+  // the default DenseQTable.
+  TabularQLearningSolver(
+    std::shared_ptr<const Game> game, double learning_rate, double discount_factor, GenericPolicy* policy, StateAbstractionFunction func,
+    std::unique_ptr<QTable> table);
+
+  // Same as above, but the solver owns the policy. Solvers that own distinct
+  // policy instances (see GenericPolicy::Clone) can be trained concurrently.
+  TabularQLearningSolver(
+    std::shared_ptr<const Game> game, double learning_rate, double discount_factor, std::unique_ptr<GenericPolicy> policy, StateAbstractionFunction func);
+
   void RunIteration();
 
-  const absl::flat_hash_map<std::pair<std::string, Action>, double>&
-  GetQValueTable() const;
+  // Plays n training episodes, stepping batch_size of them in lockstep: the
+  // policy selects the actions of the whole batch in one call, then every
+  // episode of the batch is stepped and its TD target computed from the
+  // action values before the updates of that step, which are then applied in
+  // episode order. A finished episode is replaced by a new one until n
+  // episodes have been started.
+  // With batch_size 1, or with lambda > 0 (eligibility traces belong to a
+  // single episode), this is the same as calling RunIteration n times.
+  void RunIterations(int n, int batch_size);
+
+  // Plays n training episodes on the threads of pool at once, Hogwild style:
+  // every thread plays whole episodes as RunIteration does, with its own
+  // policy, generator of chance outcomes and counters, and all of them read
+  // and update the action values of the same table without locks. Requires
+  // a table that supports concurrent updates (e.g. ConcurrentQTable or
+  // ShardedQTable) and lambda = 0.
+  // The first thread uses the policy of the solver, the others clones of it
+  // that are kept between calls, so every thread accumulates its own policy
+  // statistics. Results depend on how the threads interleave, so runs are
+  // not reproducible.
+  //
+  // The pool is used for the whole call and waited on, so it must not be
+  // shared with other work: do not call this from a task of pool, and do not
+  // call it from the tasks of another pool unless the threads of both fit the
+  // machine, since every call occupies all the threads of pool.
+  //
+  // If deterministic, training proceeds in rounds in which every thread
+  // plays one episode against the values at the start of the round,
+  // buffering its updates as TD targets; at the end of the round the buffers
+  // are applied by one thread, in thread order. The initial states of a round
+  // are created by the calling thread, in thread order, so games that draw
+  // per-state random streams from the game (e.g. pathfinding with random
+  // moves) hand them out in a fixed order. The learned values then only
+  // depend on the seeds (of the solver, of its policy and of the game) and on
+  // the number of threads of pool, not on scheduling (the ids the states get,
+  // and so the order of a saved table, still do).
+  void RunIterationsConcurrently(int n, ThreadPool* pool,
+                                 bool deterministic = false);
+
+  // Reseeds the generator used to sample chance outcomes, for reproducible
+  // runs.
+  void SetSeed(int seed) { rng_.seed(seed); }
+
+  // Eligibility traces whose absolute value falls to threshold or below are
+  // dropped, so that Q(lambda) only updates the pairs with a non-negligible
+  // trace. Clears the current traces.
+  void SetTraceThreshold(double threshold) {
+    eligibility_traces_ = EligibilityTraces(threshold);
+  }
+
+  // Keys states with func(state) instead of abstraction_func(ToString()), e.g.
+  // with a compact key that does not build the state string. Must be called
+  // before training.
+  void SetStateKeyFunction(StateKeyFunction func);
+
+  // Writes the learned state of the solver: action values, eligibility
+  // traces, the generator of chance outcomes and the state of the policy
+  // (see GenericPolicy::SaveState). Parameters and functions are not saved:
+  // Load expects a solver built the same way, and checks the game and the
+  // description of the policy.
+  void Save(CheckpointWriter* writer) const;
+  void Load(CheckpointReader* reader);
+
+  // Same as above, with a checkpoint file of its own, e.g. one per phase.
+  void SaveCheckpoint(const std::string& path) const;
+  void LoadCheckpoint(const std::string& path);
+
+  // Starts or stops collecting the runtime counters and timers of
+  // QLearningStats in RunIteration and RunIterations. Disabled by default:
+  // training then only pays an untaken branch per section of a step.
+  void EnableStats(bool enabled) { stats_enabled_ = enabled; }
+
+  // Counters collected since the last ResetStats (e.g. over the last phase),
+  // with the current sizes of the table, the traces and the policy.
+  QLearningStats GetStats() const;
+  void ResetStats() { stats_ = QLearningStats(); }
+
+  const QTable& GetQValueTable() const;
   StateAbstractionFunction GetAbstractionFunction() const;
 
+  // The function the Q-table is keyed with: the one set with
+  // SetStateKeyFunction, or else the abstraction function applied to the
+  // state string.
+  StateKeyFunction GetStateKeyFunction() const;
+
  private:
+  // Actor of RunIterationsConcurrently: shares the game, the parameters, the
+  // functions and the table of parent, and owns policy.
+  TabularQLearningSolver(const TabularQLearningSolver& parent,
+                         std::unique_ptr<GenericPolicy> policy);
+
+  // Plays one training episode, as RunIteration, from initial_state, or from
+  // a new initial state of the game if it is null.
+  void RunEpisode(std::unique_ptr<State> initial_state);
+
+  // Update of the action value of a pair buffered by the deterministic mode
+  // of RunIterationsConcurrently.
+  struct BufferedUpdate {
+    QStateId id;
+    Action action;
+    double target;
+  };
+
+  // An episode of the batched training loop.
+  struct BatchEpisode {
+    std::unique_ptr<State> state;
+    std::unique_ptr<State> next_state;
+    StepContext context;
+    StepContext next_context;
+  };
+
+  // Starts the next of the n episodes of RunIterations, skipping episodes that
+  // are over before the first decision. Returns false when all n have been
+  // started.
+  bool StartBatchEpisode(int n, int* num_started, BatchEpisode* episode);
+
+  // Fills the step context of a decision state: its abstracted key, the id of
+  // the key in the Q-table (adding the state if needed) and its legal actions.
+  // This is the only place where a state is turned into a key during training.
+  void MakeStepContext(const State& state, StepContext* context);
+
+  // Given a state, gets the best possible action from this state together with
+  // its value, reading the action values of the state in a single probe
+  QGreedyAction GetBestActionAndValue(const StepContext& context,
+                                      double min_utility);
+
   // Given a player and a state, gets the best possible action from this state
-  Action GetBestAction(const State& state, double min_utility);
+  Action GetBestAction(const StepContext& context, double min_utility);
 
   Action GetBestAction(const State& state);
 
   // Given a state, gets the best possible action value from this state
-  double GetBestActionValue(const State& state, double min_utility);
+  double GetBestActionValue(const StepContext& context, double min_utility);
 
   // Given a player and a state, gets the action, sampled from an epsilon-greedy
   // policy. Returns <action, chosen_uniformly> where the second element
   // indicates whether an action was chosen uniformly (which occurs with epsilon
   // chance).
   std::pair<Action, bool> SampleActionFromEpsilonGreedyPolicy(
-      const State& state, double min_utility);
+      const StepContext& context, double min_utility);
 
   // Moves a chance node to the next decision/terminal node by sampling from
   // the legal actions repeatedly
   void SampleUntilNextStateOrTerminal(State* state);
 
+  // If stats are enabled, charges the time since the previous lap to section.
+  void Lap(QLearningStats::Section section) {
+    if (stats_enabled_) RecordLap(section);
+  }
+  void RecordLap(QLearningStats::Section section);
+
   std::shared_ptr<const Game> game_;
   int depth_limit_;
   double epsilon_;
@@ -106,11 +250,19 @@ class TabularQLearningSolver {
   double lambda_;
   std::mt19937 rng_{(std::random_device())()};
   GenericPolicy* policy_;
-  std::tuple<absl::flat_hash_map<std::pair<std::string, Action>, double>*, double, StateAbstractionFunction> tuple;
-  absl::flat_hash_map<std::pair<std::string, Action>, double> values_;
-  absl::flat_hash_map<std::pair<std::string, Action>, double>
-      eligibility_traces_;
+  std::unique_ptr<GenericPolicy> owned_policy_;  // Set when policy_ is owned.
+  std::tuple<QTable*, double, StateAbstractionFunction> tuple;
+  std::shared_ptr<QTable> values_;  // Shared with the actors.
+  EligibilityTraces eligibility_traces_{kDefaultTraceThreshold};
   StateAbstractionFunction abstraction_func;
+  StateKeyFunction key_func_;  // Empty unless set with SetStateKeyFunction.
+  bool stats_enabled_ = false;
+  QLearningStats stats_;
+  int64_t lap_ns_ = 0;  // Time of the previous lap.
+  // Actors of the threads after the first in RunIterationsConcurrently.
+  std::vector<std::unique_ptr<TabularQLearningSolver>> actors_;
+  // If set, RunIteration appends its updates here instead of applying them.
+  std::vector<BufferedUpdate>* update_buffer_ = nullptr;
 };
 
 }  // namespace algorithms
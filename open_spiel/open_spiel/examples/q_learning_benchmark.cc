@@ -0,0 +1,383 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks of the hot paths of tabular Q-learning: whole training
+// episodes (TabularQLearningSolver::RunIteration) for every game and policy,
+// and the kernels they are made of (state strings, legal actions, children,
+// state keys and greedy selection).
+//
+// Every benchmark reports the time and the heap allocations per operation,
+// as a table on stdout and, with --json_output, as a JSON file meant to be
+// compared across runs, e.g.
+//
+//   q_learning_benchmark --filter=RunIteration/pathfinding --json_output=after.json
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/flags/flag.h"
+#include "open_spiel/abseil-cpp/absl/flags/parse.h"
+#include "open_spiel/abseil-cpp/absl/random/distributions.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_format.h"
+#include "open_spiel/abseil-cpp/absl/time/clock.h"
+#include "open_spiel/abseil-cpp/absl/time/time.h"
+#include "open_spiel/algorithms/q_table.h"
+#include "open_spiel/algorithms/tabular_q_learning.h"
+#include "open_spiel/game_transforms/turn_based_simultaneous_game.h"
+#include "open_spiel/spiel.h"
+#include "open_spiel/spiel_utils.h"
+#include "bandits/VBR_Thompson_like.h"
+#include "bandits/VBR_like_v1.h"
+#include "bandits/VBR_like_v2.h"
+#include "bandits/VBR_like_v4.h"
+#include "bandits/eps_greedy.h"
+#include "bandits/generic_policy.h"
+#include "bandits/pathfinding_helper.h"
+#include "bandits/state_abstraction_functions.h"
+
+ABSL_FLAG(std::string, filter, "",
+          "Only run the benchmarks whose name contains this string.");
+ABSL_FLAG(std::string, json_output, "",
+          "If not empty, also write the results as JSON to this file.");
+ABSL_FLAG(double, min_time, 0.5,
+          "Minimum time in seconds of the measured run of a benchmark.");
+ABSL_FLAG(int, warmup_episodes, 2000,
+          "Training episodes played before timing RunIteration, so that "
+          "the Q-table is measured close to its steady-state size.");
+ABSL_FLAG(int, maze_size, 10, "Rows and columns of the pathfinding maze.");
+ABSL_FLAG(int, seed, 1234, "Seed of the maze, the policies and the states.");
+
+namespace {
+
+// Heap allocations since the start of the program, counted by the global
+// operator new below.
+std::atomic<int64_t> num_allocations{0};
+std::atomic<int64_t> num_allocated_bytes{0};
+
+void* CountedAllocation(std::size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  num_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc();
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) { return CountedAllocation(size); }
+void* operator new[](std::size_t size) { return CountedAllocation(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace open_spiel {
+namespace {
+
+using algorithms::DenseQTable;
+using algorithms::QGreedyAction;
+using algorithms::TabularQLearningSolver;
+
+// Keeps the compiler from optimizing away the computation of value.
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchmarkResult {
+  std::string name;
+  int64_t iterations;
+  double ns_per_op;
+  double allocs_per_op;
+  double bytes_per_op;
+};
+
+// Runs body(n), which performs n operations, with n growing until a run
+// takes at least --min_time, and reports the per-operation cost of the last
+// run.
+BenchmarkResult Measure(const std::string& name,
+                        const std::function<void(int64_t)>& body) {
+  const double min_time = absl::GetFlag(FLAGS_min_time);
+  int64_t n = 1;
+  while (true) {
+    const int64_t allocations = num_allocations.load();
+    const int64_t bytes = num_allocated_bytes.load();
+    const auto start = std::chrono::steady_clock::now();
+    body(n);
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    if (seconds >= min_time || n >= (int64_t{1} << 40)) {
+      return {name, n, seconds * 1e9 / n,
+              (num_allocations.load() - allocations) / static_cast<double>(n),
+              (num_allocated_bytes.load() - bytes) / static_cast<double>(n)};
+    }
+    // Aim 20% past the minimum time, growing by at most 10x per attempt.
+    const double target = seconds > 0 ? 1.2 * min_time / seconds * n : 10 * n;
+    n = std::max<int64_t>(n + 1, std::min<double>(target, 10.0 * n));
+  }
+}
+
+// A game under benchmark, with a pool of decision states reached by random
+// play on which the kernels are measured.
+struct BenchmarkGame {
+  std::string name;
+  std::shared_ptr<const Game> game;
+  std::vector<std::unique_ptr<State>> states;
+};
+
+BenchmarkGame MakeBenchmarkGame(const std::string& name, std::mt19937& rng) {
+  GameParameters params;
+  if (name == "pathfinding") {
+    const int size = absl::GetFlag(FLAGS_maze_size);
+    params["grid"] = GameParameter(policies::maze_gen(size, size, 0.2, rng));
+    params["horizon"] = GameParameter(4 * size * size);
+  }
+  BenchmarkGame benchmark_game{name, LoadGameAsTurnBased(name, params), {}};
+
+  constexpr int kNumStates = 256;
+  while (benchmark_game.states.size() < kNumStates) {
+    std::unique_ptr<State> state = benchmark_game.game->NewInitialState();
+    while (!state->IsTerminal() && benchmark_game.states.size() < kNumStates) {
+      if (!state->IsChanceNode()) benchmark_game.states.push_back(state->Clone());
+      std::vector<Action> actions = state->LegalActions();
+      state->ApplyAction(
+          actions[absl::Uniform<int>(rng, 0, actions.size())]);
+    }
+  }
+  return benchmark_game;
+}
+
+// Benchmarks fn over the states of the pool, one state per operation.
+BenchmarkResult MeasureOnStates(
+    const std::string& name, const BenchmarkGame& benchmark_game,
+    const std::function<void(const State&)>& fn) {
+  const std::vector<std::unique_ptr<State>>& states = benchmark_game.states;
+  return Measure(name, [&](int64_t n) {
+    for (int64_t i = 0; i < n; ++i) fn(*states[i % states.size()]);
+  });
+}
+
+std::vector<std::unique_ptr<GenericPolicy>> BenchmarkPolicies() {
+  std::vector<std::unique_ptr<GenericPolicy>> benchmark_policies;
+  benchmark_policies.push_back(std::make_unique<policies::EpsilonGreedyPolicy>(0.1));
+  benchmark_policies.push_back(std::make_unique<policies::VBRLikePolicyV1>());
+  benchmark_policies.push_back(std::make_unique<policies::VBRLikePolicyV2>());
+  benchmark_policies.push_back(std::make_unique<policies::VBRLikePolicyV4>());
+  benchmark_policies.push_back(std::make_unique<policies::VBRThompsonLikePolicy>());
+  return benchmark_policies;
+}
+
+// Name of the class of the policy, without its parameters.
+std::string PolicyName(const GenericPolicy& policy) {
+  if (dynamic_cast<const policies::EpsilonGreedyPolicy*>(&policy))
+    return "EpsilonGreedyPolicy";
+  if (dynamic_cast<const policies::VBRLikePolicyV1*>(&policy))
+    return "VBRLikePolicyV1";
+  if (dynamic_cast<const policies::VBRLikePolicyV2*>(&policy))
+    return "VBRLikePolicyV2";
+  if (dynamic_cast<const policies::VBRLikePolicyV4*>(&policy))
+    return "VBRLikePolicyV4";
+  return "VBRThompsonLikePolicy";
+}
+
+class BenchmarkSuite {
+ public:
+  void Run(const std::string& name, const std::function<BenchmarkResult()>& fn) {
+    if (name.find(absl::GetFlag(FLAGS_filter)) == std::string::npos) return;
+    BenchmarkResult result = fn();
+    std::cout << absl::StrFormat("%-56s %12d %14.1f %12.2f %12.1f",
+                                 result.name, result.iterations,
+                                 result.ns_per_op, result.allocs_per_op,
+                                 result.bytes_per_op)
+              << std::endl;
+    results_.push_back(std::move(result));
+  }
+
+  void WriteJson(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) SpielFatalError(absl::StrCat("Can not write ", path));
+    file << "{\n  \"context\": {\n";
+    file << absl::StrFormat("    \"date\": \"%s\",\n",
+                            absl::FormatTime(absl::Now()));
+    file << absl::StrFormat("    \"num_cpus\": %d,\n",
+                            std::thread::hardware_concurrency());
+    file << absl::StrFormat("    \"min_time\": %g,\n",
+                            absl::GetFlag(FLAGS_min_time));
+    file << absl::StrFormat("    \"warmup_episodes\": %d,\n",
+                            absl::GetFlag(FLAGS_warmup_episodes));
+    file << absl::StrFormat("    \"maze_size\": %d,\n",
+                            absl::GetFlag(FLAGS_maze_size));
+    file << absl::StrFormat("    \"seed\": %d\n", absl::GetFlag(FLAGS_seed));
+    file << "  },\n  \"benchmarks\": [";
+    for (int i = 0; i < results_.size(); ++i) {
+      const BenchmarkResult& result = results_[i];
+      file << (i == 0 ? "\n" : ",\n");
+      file << absl::StrFormat(
+          "    {\"name\": \"%s\", \"iterations\": %d, \"ns_per_op\": %.3f, "
+          "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f}",
+          result.name, result.iterations, result.ns_per_op,
+          result.allocs_per_op, result.bytes_per_op);
+    }
+    file << "\n  ]\n}\n";
+  }
+
+ private:
+  std::vector<BenchmarkResult> results_;
+};
+
+void RunBenchmarks() {
+  const int seed = absl::GetFlag(FLAGS_seed);
+  std::mt19937 rng(seed);
+  std::vector<BenchmarkGame> games;
+  for (const std::string& name : {"pathfinding", "blackjack", "tic_tac_toe"})
+    games.push_back(MakeBenchmarkGame(name, rng));
+
+  std::cout << absl::StrFormat("%-56s %12s %14s %12s %12s", "benchmark",
+                               "iterations", "ns/op", "allocs/op",
+                               "bytes/op")
+            << std::endl;
+  BenchmarkSuite suite;
+
+  for (const BenchmarkGame& benchmark_game : games) {
+    const std::string& game_name = benchmark_game.name;
+
+    suite.Run("ToString/" + game_name, [&] {
+      return MeasureOnStates("ToString/" + game_name, benchmark_game,
+                             [](const State& state) {
+                               DoNotOptimize(state.ToString());
+                             });
+    });
+    suite.Run("LegalActions/" + game_name, [&] {
+      return MeasureOnStates("LegalActions/" + game_name, benchmark_game,
+                             [](const State& state) {
+                               DoNotOptimize(state.LegalActions());
+                             });
+    });
+    suite.Run("Child/" + game_name, [&] {
+      // The actions are chosen beforehand, to only measure Child.
+      std::vector<Action> actions;
+      for (const auto& state : benchmark_game.states)
+        actions.push_back(state->LegalActions()[0]);
+      const std::vector<std::unique_ptr<State>>& states = benchmark_game.states;
+      return Measure("Child/" + game_name, [&](int64_t n) {
+        for (int64_t i = 0; i < n; ++i) {
+          const int index = i % states.size();
+          DoNotOptimize(states[index]->Child(actions[index]));
+        }
+      });
+    });
+
+    // State keys, from the state string or from the state itself.
+    std::vector<std::pair<std::string, StateKeyFunction>> key_functions = {
+        {"identity", policies::MakeStateKeyFunction(policies::identity)},
+        {"hash_key", policies::hash_key}};
+    if (game_name == "pathfinding") {
+      key_functions.push_back(
+          {"visibility_limit_no_distinction",
+           policies::MakeStateKeyFunction(
+               policies::visibility_limit_no_distinction)});
+      key_functions.push_back(
+          {"visibility_limit_with_distinction",
+           policies::MakeStateKeyFunction(
+               policies::visibility_limit_with_distinction)});
+      key_functions.push_back(
+          {"pathfinding_compact_key", policies::pathfinding_compact_key});
+      key_functions.push_back({"pathfinding_local_view(2)",
+                               policies::pathfinding_local_view(2, true)});
+    }
+    for (const auto& [key_name, key_func] : key_functions) {
+      const std::string name = "StateKey/" + game_name + "/" + key_name;
+      suite.Run(name, [&] {
+        return MeasureOnStates(name, benchmark_game,
+                               [&key_func = key_func](const State& state) {
+                                 DoNotOptimize(key_func(state));
+                               });
+      });
+    }
+
+    // Table lookup and greedy selection on a table holding every state of
+    // the pool, keyed by state string.
+    DenseQTable table(benchmark_game.game->NumDistinctActions());
+    std::vector<std::string> keys;
+    std::vector<std::vector<Action>> legal_actions;
+    for (const auto& state : benchmark_game.states) {
+      keys.push_back(state->ToString());
+      legal_actions.push_back(state->LegalActions());
+      const algorithms::QStateId id = table.AddState(keys.back());
+      for (Action action : legal_actions.back())
+        table.SetValue(id, action, absl::Uniform(rng, -1.0, 1.0));
+    }
+    suite.Run("FindState/" + game_name, [&] {
+      return Measure("FindState/" + game_name, [&](int64_t n) {
+        for (int64_t i = 0; i < n; ++i)
+          DoNotOptimize(table.FindState(keys[i % keys.size()]));
+      });
+    });
+    suite.Run("GreedyAction/" + game_name, [&] {
+      std::vector<algorithms::QStateId> ids;
+      for (const std::string& key : keys) ids.push_back(table.FindState(key));
+      return Measure("GreedyAction/" + game_name, [&](int64_t n) {
+        for (int64_t i = 0; i < n; ++i) {
+          const int index = i % ids.size();
+          QGreedyAction greedy = table.GreedyAction(
+              ids[index], legal_actions[index],
+              std::numeric_limits<double>::lowest(), kInvalidAction);
+          DoNotOptimize(greedy.action);
+        }
+      });
+    });
+
+    // Whole training episodes, one per operation, after warming up the
+    // table.
+    for (const auto& policy : BenchmarkPolicies()) {
+      const std::string name =
+          "RunIteration/" + game_name + "/" + PolicyName(*policy);
+      suite.Run(name, [&] {
+        std::unique_ptr<GenericPolicy> instance = policy->Clone();
+        instance->SetSeed(seed);
+        TabularQLearningSolver solver(benchmark_game.game, 0.01, 0.99,
+                                      std::move(instance), policies::identity);
+        solver.SetSeed(seed);
+        for (int i = 0; i < absl::GetFlag(FLAGS_warmup_episodes); ++i)
+          solver.RunIteration();
+        return Measure(name, [&](int64_t n) {
+          for (int64_t i = 0; i < n; ++i) solver.RunIteration();
+        });
+      });
+    }
+  }
+
+  const std::string json_output = absl::GetFlag(FLAGS_json_output);
+  if (!json_output.empty()) suite.WriteJson(json_output);
+}
+
+}  // namespace
+}  // namespace open_spiel
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  open_spiel::RunBenchmarks();
+}
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -20,12 +22,14 @@
 #include <cmath>
 
 #include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
 #include "open_spiel/algorithms/tabular_q_learning.h"
 #include "open_spiel/games/tic_tac_toe.h"
 #include "open_spiel/spiel.h"
 #include "open_spiel/spiel_globals.h"
 #include "open_spiel/spiel_utils.h"
 #include "open_spiel/game_transforms/turn_based_simultaneous_game.h"
+#include "open_spiel/utils/binary_checkpoint.h"
 #include "open_spiel/games/pathfinding.h"
 #include "bandits/generic_policy.h"
 #include "bandits/eps_greedy.h"
@@ -34,6 +38,11 @@
 #include "bandits/VBR_Thompson_like.h"
 #include "bandits/pathfinding_helper.h"
 #include "bandits/state_abstraction_functions.h"
+#include "bandits/abstraction_cache.h"
+#include "bandits/experiment_runner.h"
+#include "bandits/policy_evaluator.h"
+#include "bandits/exact_evaluation.h"
+#include "bandits/results_sink.h"
 
 #include <iostream>
 #include <fstream>
@@ -54,20 +63,41 @@ using open_spiel::GameParameters;
 using open_spiel::GameParameter;
 using open_spiel::GameType;
 
+using open_spiel::algorithms::QTable;
 using open_spiel::algorithms::TabularQLearningSolver;
 using open_spiel::pathfinding::PathfindingGame;
 using policies::StateAbstractionFunction;
+using policies::StateKeyFunction;
 
-using policies::standard_deviation_calc;
-using policies::average_of;
 using policies::GetOptimalAction;
+using policies::FrozenGreedyPolicy;
 
 using policies::maze_gen;
 using policies::BFS;
 
+using policies::ExperimentRunner;
+using policies::ExperimentTask;
+using policies::PhaseScores;
+using policies::DeriveSeed;
+using policies::PolicyEvaluator;
+using policies::ExactRandomPolicyValue;
+using policies::ResultsSink;
+using policies::ResultsSummary;
+using policies::SummarizeResults;
+using policies::WriteGnuplotScript;
+using open_spiel::CheckpointReader;
+using open_spiel::CheckpointWriter;
+
 using policies::identity;
 using policies::visibility_limit_no_distinction;
 using policies::visibility_limit_with_distinction;
+using policies::pathfinding_compact_key;
+using policies::pathfinding_local_view;
+using policies::MemoizedAbstraction;
+
+std::mutex stats_file_mutex; //I test in parallelo scrivono sullo stesso file di statistiche
+
+constexpr int kMaxExactBaselineStates = 1000000; //Stati distinti oltre i quali la baseline esatta lascia il posto alla simulazione
 
 struct test_parameters {
   int n_reps = 10;
@@ -76,6 +106,14 @@ struct test_parameters {
   int n_playing = 1000;
   StateAbstractionFunction abstraction_func = identity;
   std::string tag = "id"; //Tag stringa per aggiungere informazioni per identificare il test in base alle sue caratteristiche
+  int n_threads = 0; //Thread usati per le ripetizioni indipendenti, 0 = uno per core
+  int seed = -1; //Seme dell'intero test, -1 = casuale
+  int batch_size = 1; //Episodi di addestramento giocati in parallelo dal solver, 1 = uno alla volta
+  StateKeyFunction key_func = nullptr; //Se impostata sostituisce abstraction_func (es. pathfinding_compact_key)
+  int n_eval_threads = 1; //Thread usati da ogni test per le partite di valutazione e di baseline, 0 = uno per core
+  std::string checkpoint_dir = ""; //Se non vuota ogni test salva il suo stato a fine fase in checkpoint_dir/<seme>.ckpt e, se il file esiste, riprende da li' (serve un seed fisso)
+  int abstraction_cache_size = 0; //Se positivo ogni test memorizza fino a tanti risultati di abstraction_func (vedi AbstractionCache)
+  std::string stats_file = ""; //Se non vuoto ogni test vi aggiunge, a fine fase, una riga JSON con le statistiche di addestramento della fase (vedi QLearningStats)
   
 };
 
@@ -93,24 +131,28 @@ struct pathfinding_parameters {
   int maze_repetitions = 1;
 };
 
-GameParameters PFParametersToGameParameters(pathfinding_parameters params) {
+GameParameters PFParametersToGameParameters(pathfinding_parameters params, std::mt19937& rng_) {
   GameParameters gparams;
   gparams["random_move_chance"] = GameParameter(params.random_move_chance);
-  std::string maze = maze_gen(params.n_rows, params.n_columns, params.wall_ratio);
+  std::string maze = maze_gen(params.n_rows, params.n_columns, params.wall_ratio, rng_);
   gparams["grid"] = GameParameter(maze);
   gparams["horizon"] = GameParameter(params.horizon);
+  gparams["rng_seed"] = GameParameter((int)(rng_() >> 1)); //Seme delle mosse casuali, per partite riproducibili
   return gparams;
 }
 
-absl::flat_hash_map<int, std::vector<std::pair<int, double>>> TestGenericGame
-(std::shared_ptr<const Game> game, std::vector<GenericPolicy*> policy_vec, test_parameters t_parameters, qlearning_parameters q_parameters) {
+//Addestra e valuta una copia dell'agente sul gioco, restituendo il punteggio di ogni fase. Tutta la casualita' del test deriva da seed.
+//Se impostata, on_phase riceve il punteggio di ogni fase appena calcolato (prima del checkpoint della fase)
+PhaseScores TestPolicy
+(std::shared_ptr<const Game> game, const GenericPolicy& policy, test_parameters t_parameters, qlearning_parameters q_parameters, uint32_t seed,
+ const std::function<void(int phase, double score)>& on_phase = nullptr) {
 
-  int n_reps = t_parameters.n_reps;
   int n_phases = t_parameters.n_phases;
   int n_training = t_parameters.n_training;
   int n_playing = t_parameters.n_playing;
   StateAbstractionFunction abstraction_func = t_parameters.abstraction_func;
-  std::string tag = t_parameters.tag;
+  if (t_parameters.abstraction_cache_size > 0) //Cache propria del test, nessuna contesa tra i thread
+    abstraction_func = MemoizedAbstraction(abstraction_func, t_parameters.abstraction_cache_size);
 
   double learning_rate = q_parameters.learning_rate;
   double discount_factor = q_parameters.discount_factor;
@@ -131,109 +173,143 @@ absl::flat_hash_map<int, std::vector<std::pair<int, double>>> TestGenericGame
     game_name = game->GetType().short_name;
   }
 
-  std::vector<TabularQLearningSolver*> vec_algos;
-  for (GenericPolicy* policy : policy_vec) {
-    TabularQLearningSolver* qlearning_algo = new TabularQLearningSolver(game, learning_rate, discount_factor, policy, abstraction_func);
-    vec_algos.push_back(qlearning_algo);
+  int minpassi = 0;
+  if (game_name == "pathfinding") { //Le mosse casuali usano il generatore del gioco: ogni test usa una propria istanza con il proprio seme
+    minpassi = BFS(game_parameters["grid"].string_value()); //Una volta per test, non a ogni fase
+    GameParameters seeded_parameters = game_parameters;
+    seeded_parameters.erase("name");
+    seeded_parameters["rng_seed"] = GameParameter((int)(DeriveSeed(seed, {2}) >> 1));
+    game = LoadGameAsTurnBased(game_name, seeded_parameters);
   }
 
-  std::random_device rd;
-  std::mt19937 rng_(rd());
+  std::unique_ptr<GenericPolicy> policy_instance = policy.Clone(); //Ogni test addestra la propria istanza, i test possono girare in parallelo
+  policy_instance->SetSeed(DeriveSeed(seed, {1}));
+
+  TabularQLearningSolver qlearning_algo(game, learning_rate, discount_factor, std::move(policy_instance), abstraction_func);
+  qlearning_algo.SetSeed(seed);
+  if (t_parameters.key_func)
+    qlearning_algo.SetStateKeyFunction(t_parameters.key_func);
+  const StateKeyFunction key_func = qlearning_algo.GetStateKeyFunction();
+  qlearning_algo.EnableStats(!t_parameters.stats_file.empty());
+
+  PolicyEvaluator evaluator(t_parameters.n_eval_threads);
 
   double n_wins;
   double win_percentage;
-  absl::flat_hash_map<int, std::vector<std::pair<int, double>>> phase_scores; //Usiamo un identificativo intero per riconoscere gli algoritmi, corrisponderanno alla loro posizione in vec_algos
+  PhaseScores phase_scores;
+
+  int first_phase = 0;
+  std::string checkpoint_path;
+  if (!t_parameters.checkpoint_dir.empty()) {
+    checkpoint_path = absl::StrCat(t_parameters.checkpoint_dir, "/", seed, ".ckpt");
+    if (std::ifstream(checkpoint_path).good()) { //Il test era gia' iniziato: ripartiamo dalla fase successiva all'ultimo salvataggio
+      CheckpointReader reader(checkpoint_path);
+      first_phase = reader.Read<int32_t>();
+      std::vector<double> saved_scores = reader.ReadArray<double>();
+      for (int phase = 0; phase < saved_scores.size(); phase++)
+        phase_scores.push_back({phase+1, saved_scores[phase]});
+      if (game_name == "pathfinding")
+        game->SetRNGState(reader.ReadString());
+      qlearning_algo.Load(&reader);
+    }
+  }
 
-  std::cout<<"INIZIO INTERNO"<<std::endl;
-  for (int algo_id = 0; algo_id < vec_algos.size();  algo_id++) {
-    for (int phase = 0; phase < n_phases; phase++) { //Ripetiamo il test in n_phases fasi per notare l'evoluzione dei risultati al miglioramento della tabella
+  for (int phase = first_phase; phase < n_phases; phase++) { //Ripetiamo il test in n_phases fasi per notare l'evoluzione dei risultati al miglioramento della tabella
 
-      for (int iter = 0; iter < n_training; iter++) { //Eseguiamo n_training iterazioni in cui addestriamo l'agente
-        // std::cout<<"FASE NUMERO "<<phase+1<<" ITERAZIONE NUMERO "<<iter+1<<std::endl;
-        vec_algos[algo_id]->RunIteration();
-      }
+    qlearning_algo.RunIterations(n_training, t_parameters.batch_size); //Eseguiamo n_training iterazioni in cui addestriamo l'agente
 
-      n_wins = 0;
-      std::vector<double> vec_returns;
-      absl::flat_hash_map<std::pair<std::string, Action>, double> QTable = vec_algos[algo_id]->GetQValueTable();
-
-      for (int match = 0; match < n_playing; match++) { //L'agente gioca al suo meglio n_playing volte, per avere una stima accurata della sua bravura
-        std::unique_ptr<State> state = game->NewInitialState();
-        while (!state->IsTerminal()) {
-          if (state->CurrentPlayer() != 0) {
-            std::vector<Action> legal_actions = state->LegalActions();
-            Action random_action = legal_actions[absl::Uniform<int>(rng_, 0, legal_actions.size())];
-            state->ApplyAction(random_action);
-          }
-          else {
-            Action optimal_action = GetOptimalAction(&QTable, *state, abstraction_func);
-            state->ApplyAction(optimal_action);
-          }
-        }
-        vec_returns.push_back(state->Returns()[0]);
-      }
+    if (!t_parameters.stats_file.empty()) {
+      std::string line = absl::StrCat("{\"seed\": ", seed, ", \"policy\": \"", policy.toString(), "\", \"phase\": ", phase+1,
+                                      ", \"stats\": ", qlearning_algo.GetStats().ToJson(), "}\n");
+      qlearning_algo.ResetStats(); //Statistiche della singola fase
+      std::lock_guard<std::mutex> lock(stats_file_mutex);
+      std::ofstream(t_parameters.stats_file, std::ios::app) << line;
+    }
 
-      if (game_name == "pathfinding") { //Dobbiamo ricavare il numero di passi impiegato partendo dal valore ritornato, lavoriamo diversamente
+    n_wins = 0;
+    const FrozenGreedyPolicy greedy_policy(qlearning_algo.GetQValueTable(), key_func); //Tabella congelata e compatta per la valutazione
 
-        int horizon = game_parameters["horizon"].int_value();
-        double success_reward = game_parameters["solve_reward"].double_value()+game_parameters["group_reward"].double_value();
-        double penalty = abs(game_parameters["step_reward"].double_value());
-        std::string grid = game_parameters["grid"].string_value();
-        int minpassi = BFS(grid);
-
-        std::vector<double> vec_passi;
-
-        for (double ret : vec_returns) {
-          if (ret - horizon * penalty < 0.1) { //L'uguaglianza tra double si comporta in modo inconsistente
-            vec_passi.push_back(horizon);
-          }
-          else {
-            vec_passi.push_back(((success_reward-ret)/penalty)+1.0);
-          }
-        }
+    //L'agente gioca al suo meglio n_playing volte, per avere una stima accurata della sua bravura
+    std::vector<double> vec_returns = evaluator.Evaluate(*game, greedy_policy, n_playing, DeriveSeed(seed, {3, (uint32_t)phase})).returns;
+
+    if (game_name == "pathfinding") { //Dobbiamo ricavare il numero di passi impiegato partendo dal valore ritornato, lavoriamo diversamente
+
+      int horizon = game_parameters["horizon"].int_value();
+      double success_reward = game_parameters["solve_reward"].double_value()+game_parameters["group_reward"].double_value();
+      double penalty = abs(game_parameters["step_reward"].double_value());
 
-        double avg = 0;
-        for (double n_passi : vec_passi) {
-          double relative_value = (horizon-n_passi)/((double)(horizon-minpassi));
-          avg+=relative_value;
+      std::vector<double> vec_passi;
+
+      for (double ret : vec_returns) {
+        if (ret - horizon * penalty < 0.1) { //L'uguaglianza tra double si comporta in modo inconsistente
+          vec_passi.push_back(horizon);
         }
-        avg/=vec_passi.size();
-        phase_scores[algo_id].push_back({phase+1, avg});
-      }
-      else {
-        for (double ret : vec_returns) {
-          // if (ret == game->MaxUtility()) //Vittoria stretta, bisogna controllare in base al singolo gioco se funziona
-          //   n_wins++;
-          if (ret >= 0) //Vittoria o pareggio, solitamente funziona ma conviene comunque controllare i ritorni del singolo gioco
-            n_wins++;
+        else {
+          vec_passi.push_back(((success_reward-ret)/penalty)+1.0);
         }
-        win_percentage = n_wins/((double)n_playing);
-        phase_scores[algo_id].push_back({phase+1, win_percentage});
       }
 
+      double avg = 0;
+      for (double n_passi : vec_passi) {
+        double relative_value = (horizon-n_passi)/((double)(horizon-minpassi));
+        avg+=relative_value;
+      }
+      avg/=vec_passi.size();
+      phase_scores.push_back({phase+1, avg});
+    }
+    else {
+      for (double ret : vec_returns) {
+        // if (ret == game->MaxUtility()) //Vittoria stretta, bisogna controllare in base al singolo gioco se funziona
+        //   n_wins++;
+        if (ret >= 0) //Vittoria o pareggio, solitamente funziona ma conviene comunque controllare i ritorni del singolo gioco
+          n_wins++;
+      }
+      win_percentage = n_wins/((double)n_playing);
+      phase_scores.push_back({phase+1, win_percentage});
     }
 
-  }
-
-  std::cout<<"FINE INTERNO"<<std::endl;
+    if (on_phase)
+      on_phase(phase_scores.back().first, phase_scores.back().second);
+
+    if (!checkpoint_path.empty()) {
+      CheckpointWriter writer;
+      writer.Write<int32_t>(phase+1);
+      std::vector<double> saved_scores;
+      for (const auto& [saved_phase, score] : phase_scores)
+        saved_scores.push_back(score);
+      writer.WriteArray<double>(saved_scores);
+      if (game_name == "pathfinding") //Le partite future dipendono dal generatore del gioco
+        writer.WriteString(game->GetRNGState());
+      qlearning_algo.Save(&writer);
+      writer.Save(checkpoint_path);
+    }
 
-  for (TabularQLearningSolver* qlearning : vec_algos) {
-    delete qlearning;
   }
 
   return phase_scores;
 
 }
 
-void TestGenericGameMulti(std::string game_name, std::vector<GenericPolicy*> policy_vec, test_parameters t_parameters, qlearning_parameters q_parameters, 
-  pathfinding_parameters p_parameters = {}) {
+absl::flat_hash_map<int, std::vector<std::pair<int, double>>> TestGenericGame
+(std::shared_ptr<const Game> game, std::vector<GenericPolicy*> policy_vec, test_parameters t_parameters, qlearning_parameters q_parameters) {
 
   std::random_device rd;
-  std::mt19937 rng_(rd());
 
-  absl::flat_hash_map<int, absl::flat_hash_map<int, std::vector<double>>>* results = new absl::flat_hash_map<int, absl::flat_hash_map<int, std::vector<double>>>; //A ogni algoritmo sono associate n_phases fasi, ad ogni fase sono associate n_reps risultati
+  absl::flat_hash_map<int, std::vector<std::pair<int, double>>> phase_scores; //Usiamo un identificativo intero per riconoscere gli algoritmi, corrisponderanno alla loro posizione in policy_vec
 
-  double baseline_wins = 0;
+  std::cout<<"INIZIO INTERNO"<<std::endl;
+  for (int algo_id = 0; algo_id < policy_vec.size();  algo_id++) {
+    phase_scores[algo_id] = TestPolicy(game, *policy_vec[algo_id], t_parameters, q_parameters, rd());
+  }
+
+  std::cout<<"FINE INTERNO"<<std::endl;
+
+  return phase_scores;
+
+}
+
+void TestGenericGameMulti(std::string game_name, std::vector<GenericPolicy*> policy_vec, test_parameters t_parameters, qlearning_parameters q_parameters, 
+  pathfinding_parameters p_parameters = {}) {
 
   int n_reps = t_parameters.n_reps;
   int n_phases = t_parameters.n_phases;
@@ -249,16 +325,36 @@ void TestGenericGameMulti(std::string game_name, std::vector<GenericPolicy*> pol
   double random_move_chance = p_parameters.random_move_chance;
   int maze_reps = p_parameters.maze_repetitions;
 
-  GameParameters game_parameters;
+  std::stringstream basename;
+  if (game_name == "pathfinding") {
+    basename << game_name<<":"<<n_rows<<"*"<<n_columns<<"ratio("<<wall_ratio<<")horizon("<<horizon<<")random_chance("<<random_move_chance<<")"<<
+    n_reps<<"rep, ("<<n_training<<") ["<<tag<<"]";
+  } else {
+    basename <<game_name<<":"<<n_reps<<"rep, ("<<n_training<<") ["<<tag<<"]";
+  }
+
+  //I risultati sono scritti su file man mano che vengono prodotti; se il test riprende dai checkpoint si aggiungono a quelli gia' salvati
+  ResultsSink sink(basename.str() + ".csv", !t_parameters.checkpoint_dir.empty());
+  for (int i = 0; i < policy_vec.size(); i++)
+    sink.RecordPolicy(i, policy_vec[i]->toString());
+
+  uint32_t base_seed = (t_parameters.seed < 0 ? std::random_device()() : t_parameters.seed);
+  ExperimentRunner runner(t_parameters.n_threads, base_seed);
 
-  for (int rep = 0; rep < n_reps; rep++) {
+  //Ogni ripetizione genera il proprio labirinto e la propria baseline in parallelo, con un seme che dipende solo dal suo indice
+  std::vector<std::shared_ptr<const Game>> games(n_reps);
+
+  runner.ParallelFor(n_reps, [&](int rep) {
+
+    std::mt19937 rng_(runner.Seed({(uint32_t)rep}));
 
     GameParameters setting_parameters;
     if (game_name == "pathfinding") {
-      setting_parameters = PFParametersToGameParameters(p_parameters);
+      setting_parameters = PFParametersToGameParameters(p_parameters, rng_);
     }
 
     std::shared_ptr<const Game> game_pointer = LoadGameAsTurnBased(game_name, setting_parameters);
+    games[rep] = game_pointer;
 
     GameParameters game_parameters;
 
@@ -272,183 +368,68 @@ void TestGenericGameMulti(std::string game_name, std::vector<GenericPolicy*> pol
     int n_random_matches = n_playing*n_phases;
     n_random_matches*=maze_reps; //Se il gioco è pathfinding dobbiamo tenere conto delle volte che si ripete il singolo labirinto (Se non è pathfinding varrà 1)
 
-    for (int match = 0; match < n_random_matches; match++) {
-      std::unique_ptr<State> state = game_pointer->NewInitialState();
-      while (!state->IsTerminal()) {
-        std::vector<Action> legal_actions = state->LegalActions();
-        Action random_action = legal_actions[absl::Uniform<int>(rng_, 0, legal_actions.size())];
-        state->ApplyAction(random_action);
-      }
+    int minpassi = 0;
+    if (game_name == "pathfinding")
+      minpassi = BFS(game_parameters["grid"].string_value()); //Stesso labirinto per tutte le partite della ripetizione
+
+    //Punteggio di una partita a partire dal ritorno, come per l'agente
+    auto baseline_score = [&](double random_return) {
       if (game_name == "pathfinding") {
 
         int horizon = game_parameters["horizon"].int_value();
         double success_reward = game_parameters["solve_reward"].double_value()+game_parameters["group_reward"].double_value();
         double penalty = abs(game_parameters["step_reward"].double_value());
-        std::string grid = game_parameters["grid"].string_value();
-        int minpassi = BFS(grid);
         int n_passi;
 
-        if (state->Returns()[0] - horizon * penalty < 0.1) { //L'uguaglianza tra double si comporta in modo inconsistente
+        if (random_return - horizon * penalty < 0.1) { //L'uguaglianza tra double si comporta in modo inconsistente
           n_passi = horizon;
         }
         else {
-          n_passi = (((success_reward-state->Returns()[0])/penalty)+1);
+          n_passi = (((success_reward-random_return)/penalty)+1);
         }
 
-        baseline_wins+=((horizon-n_passi)/((double)(horizon-minpassi)));
-      }
-      else {
-        if (state->Returns()[0] >= 0) //Se il gioco non è pathfinding assumiamo che ci basti controllare se il gioco ritorna un valore nonnegativo come vittoria/pareggio
-          baseline_wins++;
+        return ((horizon-n_passi)/((double)(horizon-minpassi)));
       }
+      //Se il gioco non è pathfinding assumiamo che ci basti controllare se il gioco ritorna un valore nonnegativo come vittoria/pareggio
+      return (random_return >= 0 ? 1.0 : 0.0);
+    };
+
+    //Dove lo stato e' descritto completamente da ToString (e dal numero di mosse) calcoliamo il valore atteso esatto, altrimenti
+    //simuliamo le partite. Pathfinding con mosse casuali usa un generatore interno, blackjack nasconde il mazzo a ToString
+    bool exact_game = (game_name == "pathfinding" && random_move_chance == 0) || game_name == "tic_tac_toe";
+    double expected_score;
+    if (exact_game && ExactRandomPolicyValue(*game_pointer, [&](const State& terminal) { return baseline_score(terminal.Returns()[0]); },
+                                             kMaxExactBaselineStates, &expected_score)) {
+      sink.RecordBaseline(rep, expected_score);
     }
-
-    //Testiamo effettivamente il gioco, utilizzando i risultati accumulati dell'iterazione
-
-    for (int m_rep = 0; m_rep < maze_reps; m_rep++) { //Ripetiamo lo stesso test maze_repetitions volte
-
-      std::cout<<"LABIRINTO NUMERO "<<rep<<" RIPETIZIONE NUMERO "<<m_rep<<std::endl;
-     
-      absl::flat_hash_map<int, std::vector<std::pair<int, double>>> curr_res = TestGenericGame(game_pointer, policy_vec, t_parameters, q_parameters);
-
-      std::cout<<"FINE TEST"<<std::endl<<std::endl;
-
-      for (int algo = 0; algo < curr_res.size(); algo++) { //La taglia della mappa sarà data dal numero di algoritmi utilizzati nel test
-        std::vector<std::pair<int, double>> phase_scores_algo = curr_res.at(algo);
-        for (int i = 0; i < phase_scores_algo.size(); i++) {
-            std::pair<int, double> curr_pair = phase_scores_algo[i];
-            (*results)[algo][curr_pair.first].push_back(curr_pair.second); //Aggiungiamo alla coppia algoritmo-fase il valore ricavato nella ripetizione rep (corrente)
-        }
-      }
-
+    else {
+      PolicyEvaluator evaluator(t_parameters.n_eval_threads);
+      std::vector<double> random_returns = evaluator.Evaluate(*game_pointer, nullptr, n_random_matches, runner.Seed({(uint32_t)rep, 1})).returns;
+      double baseline_wins = 0;
+      for (double random_return : random_returns)
+        baseline_wins += baseline_score(random_return);
+      sink.RecordBaseline(rep, baseline_wins/n_random_matches);
     }
+  });
 
-  }
-
-  double baseline_value = baseline_wins/((double)(n_playing*n_reps*n_phases*maze_reps));
+  //Testiamo effettivamente il gioco: ogni coppia (ripetizione, agente) e' un addestramento indipendente su una copia dell'agente,
+  //quindi tutti i test possono essere eseguiti in parallelo
 
-  double max_y;
-  double min_y;
+  std::vector<ExperimentTask> tasks = runner.MakeTasks(n_reps, maze_reps, policy_vec.size());
 
-  for (int algo = 0; algo < results->size(); algo++) {
-  absl::flat_hash_map<int, std::vector<double>>& map = results->at(algo);
-    for (int phase = 1; phase <= map.size(); phase++) { //Le fasi sono numerate da 1 piuttosto che da 0
-      std::vector<double>& phase_results = map.at(phase);
-      double avg = average_of(phase_results);
-      double st_dev = standard_deviation_calc(phase_results, avg);
-      if (algo == 0 && phase == 1) {
-        max_y = min_y = avg;
-      }
-      else if (avg-st_dev < min_y) {
-        min_y = avg-st_dev;
-      }
-      else if (avg+st_dev > max_y) {
-        max_y = avg+st_dev;
-      }
-    }
-  } 
+  runner.ParallelFor(tasks.size(), [&](int i) {
+    const ExperimentTask& task = tasks[i];
+    std::cout<<"LABIRINTO NUMERO "<<task.rep<<" RIPETIZIONE NUMERO "<<task.maze_rep<<" AGENTE "<<task.policy_index<<std::endl;
+    TestPolicy(games[task.rep], *policy_vec[task.policy_index], t_parameters, q_parameters, task.seed,
+               [&](int phase, double score) { sink.RecordScore(task, phase, score); });
+  });
 
-  if (baseline_value < min_y)
-    min_y = baseline_value;
-  else if (baseline_value > max_y)
-    max_y = baseline_value;
-
-  std::stringstream basename;
-  if (game_name == "pathfinding") {
-    basename << game_name<<":"<<n_rows<<"*"<<n_columns<<"ratio("<<wall_ratio<<")horizon("<<horizon<<")random_chance("<<random_move_chance<<")"<<
-    n_reps<<"rep, ("<<n_training<<") ["<<tag<<"]";
-  } else {
-    basename <<game_name<<":"<<n_reps<<"rep, ("<<n_training<<") ["<<tag<<"]";
-  }
-  std::ofstream file_dati("gnu " + basename.str() + ".txt");
-
-  file_dati << "set terminal pngcairo size 1800,900\n";
-  file_dati << "set output '"<< basename.str() << ".png'\n";
-  file_dati << "set title '"<<game_name<<"'\n";
-  file_dati << "set xlabel 'fase'\n";
-   if (game_name == "pathfinding") {
-    file_dati << "set ylabel 'efficienza relativa'\n";
-  } else {
-    file_dati << "set ylabel 'pr. media di vincita'\n";
-  }
-  file_dati << "set datafile separator ' '\n";
-
-  file_dati << "set xrange [" << 1 << ":" << n_phases+results->size()*0.04+0.1<< "]\n";
-  file_dati << "set yrange [" << min_y-0.05 << ":" << max_y+0.05 << "]\n";
-  file_dati << "set xtics 1\n";
-  file_dati << "set ytics 0.1\n";
-
-  file_dati << "set key outside\n";
-
-  file_dati << "set grid\n";
-  file_dati << "set arrow from 1,"<< baseline_value <<" to "<< n_phases+results->size()*0.04+0.1 <<","<< baseline_value <<" nohead lt 2 lc 'black' dt 2\n"; //La baseline essendo una linea orizzontale possiamo mapparla con una arrow
-  file_dati << "set palette model HSV defined ( 0 0 1 1, 1 1 1 1 ) \n";
-
-  file_dati << "plot ";
-
-  double dt;
-  double pt;
-  double n_eps = 0;
-  double n_vbr = 0;
-  double n_thompson = 0;
-  double i_eps = -1;
-  double i_vbr = -1;
-  double i_thompson = -1;
-  double palette_frac_value = 0.0;
-
-  for (int i = 0; i < policy_vec.size(); i++) {
-    if (policy_vec[i]->toString().find("Epsilon") != std::string::npos) {
-      n_eps++;
-    } else if (policy_vec[i]->toString().find("Thompson") != std::string::npos) {
-      n_thompson++;
-    }
-    else  {
-      n_vbr++;
-    }
-
-  }
-
-  for (int i = 0; i < policy_vec.size(); i++) {
-    if (policy_vec[i]->toString().find("Epsilon") != std::string::npos) {
-      dt = 2;
-      pt = 20;
-      i_eps++;
-      palette_frac_value = i_eps/n_eps;
-    } else if (policy_vec[i]->toString().find("Thompson") != std::string::npos) {
-      dt = 3;
-      i_thompson++;
-      palette_frac_value = i_thompson/n_thompson;
-      pt = 9;
-    }
-    else  {
-      dt = 1;
-      pt = 7;
-      i_vbr++;
-      palette_frac_value = i_vbr/n_vbr;
-    }
-
-    file_dati << "'-' with yerrorlines title '" + policy_vec[i]->toString() + "' lt 1 lc palette frac "<< palette_frac_value <<" dt "<<dt<<" pt "<<pt<<", ";
-
-  }
-
-  file_dati << "1/0 t 'Baseline (random)' lt 2 lc 'black' dt 2\n"; //Creiamo una linea fittizia (1/0 non essendo calcolabile creerà una linea vuota)
-            //solo per avere un nome per la baseline nella legenda (Le arrow non possono avere un nome)
-
-  for (int algo = 0; algo < results->size(); algo++) {
-    absl::flat_hash_map<int, std::vector<double>>& map = results->at(algo);
-    for (int phase = 1; phase <= map.size(); phase++) { //Le fasi sono numerate da 1 piuttosto che da 0
-      std::vector<double>& phase_results = map.at(phase);
-      double avg = average_of(phase_results);
-      double st_dev = standard_deviation_calc(phase_results, avg);
-      double phase_value;
-      phase_value = phase+(0.04*algo)+0.01;
-      file_dati << phase_value << " " << avg << " " << st_dev << "\n";
-
-    }
-    file_dati << "e\n";
-  }
+  std::cout<<"FINE TEST"<<std::endl<<std::endl;
 
-  file_dati.close();
+  //Il grafico si ricava dal solo file dei risultati, e puo' essere rigenerato anche da un test interrotto
+  const ResultsSummary summary = SummarizeResults(sink.path());
+  WriteGnuplotScript(summary, {game_name, game_name == "pathfinding" ? "efficienza relativa" : "pr. media di vincita", basename.str() + ".png"},
+                     "gnu " + basename.str() + ".txt");
 
 }
 
@@ -462,6 +443,8 @@ int main(int argc, char** argv) {
   test_parameters t_params2 = {40, 10, 100, 100, identity, "id rand EPS"};
   test_parameters t_params3 = {40, 10, 100, 1, visibility_limit_no_distinction, "limit no dis EPS"};
   test_parameters t_params4 = {40, 10, 100, 1, visibility_limit_with_distinction, "limit dis EPS"};
+  t_params3.key_func = pathfinding_local_view(1, false); //Stesse partizioni delle funzioni su stringa, senza ricostruire la griglia
+  t_params4.key_func = pathfinding_local_view(1, true);
 
   test_parameters t_params5 = {20, 10, 100, 1000, identity, "id"};
   test_parameters t_params6 = {20, 10, 1000, 1000, identity, "id"};
@@ -21,10 +21,14 @@
 
 #include "open_spiel/spiel.h"
 #include "open_spiel/spiel_globals.h"
+#include "open_spiel/utils/zobrist.h"
 
 namespace open_spiel {
 
 namespace {
+
+constexpr uint64_t kZobristSalt = 0x7475726e62617365ULL;
+
 // These parameters reflect the most-general game, with the maximum
 // API coverage. The actual game may be simpler and might not provide
 // all the interfaces.
@@ -149,6 +153,20 @@ std::string TurnBasedSimultaneousState::ToString() const {
   return partial_action + state_->ToString();
 }
 
+uint64_t TurnBasedSimultaneousState::HashKey() const {
+  uint64_t hash = state_->HashKey();
+  if (rollout_mode_) {
+    // Same information as the partial joint action prefix of ToString.
+    hash ^= ZobristKey(kZobristSalt, 0);
+    for (auto p = Player{0}; p < current_player_; ++p) {
+      hash ^= ZobristKey(kZobristSalt,
+                         (static_cast<uint64_t>(p + 1) << 32) |
+                             static_cast<uint32_t>(action_vector_[p]));
+    }
+  }
+  return hash;
+}
+
 bool TurnBasedSimultaneousState::IsTerminal() const {
   return state_->IsTerminal();
 }
@@ -43,6 +43,8 @@ class TurnBasedSimultaneousState : public State {
   Player CurrentPlayer() const override;
   std::string ActionToString(Player player, Action action_id) const override;
   std::string ToString() const override;
+  // Combines the hash of the wrapped state with the partial joint action.
+  uint64_t HashKey() const override;
   bool IsTerminal() const override;
   std::vector<double> Returns() const override;
   std::vector<double> Rewards() const override;
@@ -115,6 +117,10 @@ class TurnBasedSimultaneousGame : public Game {
   int MaxChanceNodesInHistory() const override {
     return game_->MaxChanceNodesInHistory();
   }
+  std::string GetRNGState() const override { return game_->GetRNGState(); }
+  void SetRNGState(const std::string& rng_state) const override {
+    game_->SetRNGState(rng_state);
+  }
 
  private:
   std::shared_ptr<const Game> game_;
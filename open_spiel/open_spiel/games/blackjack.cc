@@ -22,6 +22,7 @@
 #include "open_spiel/game_parameters.h"
 #include "open_spiel/spiel.h"
 #include "open_spiel/spiel_globals.h"
+#include "open_spiel/utils/zobrist.h"
 
 namespace open_spiel {
 namespace blackjack {
@@ -37,6 +38,16 @@ constexpr int kAceValue = 1;
 constexpr int kApproachScore = 21;
 constexpr int kInitialCardsPerPlayer = 2;
 
+// Salts of the Zobrist keys of the features of a state, see HashKey.
+constexpr uint64_t kNonAceTotalSalt = 0x626a6b746f74616cULL;
+constexpr uint64_t kNumAcesSalt = 0x626a6b6163657300ULL;
+constexpr uint64_t kChanceSalt = 0x626a6b6368616e63ULL;
+
+// Zobrist key of "player has value", values being below 2^16.
+uint64_t PlayerValueKey(uint64_t salt, int player, int value) {
+  return ZobristKey(salt, (static_cast<uint64_t>(player) << 16) | value);
+}
+
 // Facts about the game
 const GameType kGameType{/*short_name=*/"blackjack",
                          /*long_name=*/"Blackjack",
@@ -190,9 +201,13 @@ void BlackjackState::DealCardToPlayer(int player, int card) {
   cards_[player].push_back(card);
   const int value = CardValue(card);
   if (value == kAceValue) {
+    hash_ ^= PlayerValueKey(kNumAcesSalt, player, num_aces_[player]);
     num_aces_[player]++;
+    hash_ ^= PlayerValueKey(kNumAcesSalt, player, num_aces_[player]);
   } else {
+    hash_ ^= PlayerValueKey(kNonAceTotalSalt, player, non_ace_total_[player]);
     non_ace_total_[player] += value;
+    hash_ ^= PlayerValueKey(kNonAceTotalSalt, player, non_ace_total_[player]);
   }
 }
 
@@ -211,6 +226,11 @@ BlackjackState::BlackjackState(std::shared_ptr<const Game> game) : State(game) {
 
   deck_.resize(kDeckSize);
   std::iota(deck_.begin(), deck_.end(), 0);
+
+  for (int player = 0; player <= game_->NumPlayers(); ++player) {
+    hash_ ^= PlayerValueKey(kNonAceTotalSalt, player, 0);
+    hash_ ^= PlayerValueKey(kNumAcesSalt, player, 0);
+  }
 }
 
 int BlackjackState::GetBestPlayerTotal(int player) const {
@@ -329,6 +349,11 @@ std::string BlackjackState::ToString() const {
                                                       : ", Player's Turn\n"));
 }
 
+uint64_t BlackjackState::HashKey() const {
+  return cur_player_ == kChancePlayerId ? hash_ ^ ZobristKey(kChanceSalt, 0)
+                                        : hash_;
+}
+
 std::unique_ptr<State> BlackjackState::Clone() const {
   return std::unique_ptr<State>(new BlackjackState(*this));
 }
@@ -15,6 +15,7 @@
 #ifndef OPEN_SPIEL_GAMES_BLACKJACK_H_
 #define OPEN_SPIEL_GAMES_BLACKJACK_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,6 +43,7 @@ class BlackjackState : public State {
   Player CurrentPlayer() const override;
   std::string ActionToString(Player player, Action move_id) const override;
   std::string ToString() const override;
+  uint64_t HashKey() const override;
   bool IsTerminal() const override;
   std::vector<double> Returns() const override;
   std::vector<double> Rewards() const override;
@@ -81,6 +83,9 @@ class BlackjackState : public State {
   std::vector<int> turn_over_;           // Whether each player's turn is over.
   std::vector<int> deck_;                // Remaining cards in the deck.
   std::vector<std::vector<int>> cards_;  // Cards dealt to each player.
+  // Zobrist hash of non_ace_total_ and num_aces_, which with the chance flag
+  // are what ToString shows.
+  uint64_t hash_ = 0;
 };
 
 class BlackjackGame : public Game {
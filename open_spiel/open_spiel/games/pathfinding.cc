@@ -18,9 +18,11 @@
 #include <cctype>
 #include <map>
 #include <memory>
+#include <sstream>
 #include <utility>
 
 #include "open_spiel/abseil-cpp/absl/container/flat_hash_map.h"
+#include "open_spiel/abseil-cpp/absl/numeric/bits.h"
 #include "open_spiel/abseil-cpp/absl/random/distributions.h"
 #include "open_spiel/abseil-cpp/absl/random/random.h"
 #include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
@@ -30,6 +32,7 @@
 #include "open_spiel/spiel_utils.h"
 #include "open_spiel/utils/combinatorics.h"
 #include "open_spiel/utils/tensor_view.h"
+#include "open_spiel/utils/zobrist.h"
 
 namespace open_spiel {
 namespace pathfinding {
@@ -39,6 +42,15 @@ namespace {
 constexpr std::array<int, kNumActions> kRowOffsets = {0, 0, -1, 0, 1};
 constexpr std::array<int, kNumActions> kColOffsets = {0, -1, 0, 1, 0};
 
+constexpr uint64_t kZobristSalt = 0x7061746866696e64ULL;
+
+// Zobrist key of "player is on coord".
+uint64_t PositionKey(Player player, const std::pair<int, int>& coord) {
+  return ZobristKey(kZobristSalt, (static_cast<uint64_t>(player) << 40) |
+                                      (static_cast<uint64_t>(coord.first) << 20) |
+                                      coord.second);
+}
+
 // Register with general sum, since the game is not guaranteed to be zero sum.
 // If we create a zero sum instance, the type on the created game will show it.
 const GameType kGameType{
@@ -62,7 +74,8 @@ const GameType kGameType{
      {"players", GameParameter(kDefaultNumPlayers)},
      {"solve_reward", GameParameter(kDefaultSolveReward)},
      {"step_reward", GameParameter(kDefaultStepReward)},
-     {"random_move_chance", GameParameter(kDefaultRandomMoveChance)}}};
+     {"random_move_chance", GameParameter(kDefaultRandomMoveChance)},
+     {"rng_seed", GameParameter(kDefaultRngSeed)}}};
 
 std::shared_ptr<const Game> Factory(const GameParameters& params) {
   return std::shared_ptr<const Game>(new PathfindingGame(params));
@@ -147,7 +160,8 @@ PathfindingState::PathfindingState(std::shared_ptr<const Game> game,
       rewards_(num_players_, 0.0),
       returns_(num_players_, 0.0),
       contested_players_(num_players_, 0),
-      reached_destinations_(num_players_, 0) {
+      reached_destinations_(num_players_, 0),
+      rng_stream_(parent_game_.NewStreamSeed()) {
   grid_.reserve(grid_spec_.num_rows);
   for (int r = 0; r < grid_spec_.num_rows; ++r) {
     grid_.push_back(std::vector<int>(grid_spec_.num_cols, kEmpty));
@@ -163,6 +177,7 @@ PathfindingState::PathfindingState(std::shared_ptr<const Game> game,
     SPIEL_CHECK_EQ(grid_[c.first][c.second], kEmpty);
     grid_[c.first][c.second] = p;
     player_positions_[p] = c;
+    hash_ ^= PositionKey(p, c);
   }
 }
 
@@ -175,19 +190,17 @@ void PathfindingState::DoApplyActions(const std::vector<Action>& moves) {
   SPIEL_CHECK_EQ(moves.size(), num_players_);
   SPIEL_CHECK_EQ(cur_player_, kSimultaneousPlayerId);
 
-  std::random_device rd;
-  std::mt19937 rng_(rd());
-
   std::fill(rewards_.begin(), rewards_.end(), 0.0);
   std::fill(contested_players_.begin(), contested_players_.end(), 0);
 
   actions_ = moves;
 
-  if (absl::Uniform(rng_, 0.0, 1.0) < parent_game_.random_move_chance()) { //Inseriamo un errore nella selezione dell'azione
-    if (absl::Uniform(rng_, 0.0, 1.0) <= 0.5)
-      actions_[0] = (actions_[0]-1)%5;
+  if (parent_game_.random_move_chance() > 0 &&
+      NextUniform() < parent_game_.random_move_chance()) { //Inseriamo un errore nella selezione dell'azione
+    if (NextUniform() <= 0.5)
+      actions_[0] = (actions_[0]+kNumActions-1)%kNumActions;
     else
-      actions_[0] = (actions_[0]+1)%5;
+      actions_[0] = (actions_[0]+1)%kNumActions;
   }
 
   if (num_players_ == 1) {
@@ -211,6 +224,15 @@ void PathfindingState::DoApplyActions(const std::vector<Action>& moves) {
   }
 }
 
+double PathfindingState::NextUniform() {
+  // SplitMix64 of the counter: 53 random bits, mapped to [0, 1).
+  uint64_t z = rng_stream_ + (++rng_counter_) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z ^= z >> 31;
+  return (z >> 11) * 0x1.0p-53;
+}
+
 bool PathfindingState::InBounds(int r, int c) const {
   return (r >= 0 && c >= 0 && r < grid_spec_.num_rows &&
           c < grid_spec_.num_cols);
@@ -252,6 +274,7 @@ void PathfindingState::ResolvePlayerAction(Player p) {
 
   grid_[cur_coord.first][cur_coord.second] = kEmpty;
   grid_[next_coord.first][next_coord.second] = p;
+  hash_ ^= PositionKey(p, cur_coord) ^ PositionKey(p, next_coord);
   player_positions_[p] = next_coord;
 }
 
@@ -432,6 +455,25 @@ Player PathfindingState::PlayerAtPos(const std::pair<int, int>& coord) const {
   }
 }
 
+uint64_t PathfindingState::CompactKey(bool with_move_count) const {
+  const int cell_bits =
+      std::max(1, static_cast<int>(absl::bit_width(static_cast<uint64_t>(
+                      grid_spec_.num_rows * grid_spec_.num_cols - 1))));
+  int num_bits = num_players_ * cell_bits;
+  if (with_move_count) {
+    num_bits += absl::bit_width(static_cast<uint64_t>(horizon_));
+  }
+  SPIEL_CHECK_LE(num_bits, 64);
+
+  uint64_t key = with_move_count ? total_moves_ : 0;
+  for (Player p = num_players_ - 1; p >= 0; --p) {
+    key = (key << cell_bits) |
+          (player_positions_[p].first * grid_spec_.num_cols +
+           player_positions_[p].second);
+  }
+  return key;
+}
+
 std::string PathfindingState::ToString() const {
   std::string str;
   for (int r = 0; r < grid_spec_.num_rows; ++r) {
@@ -628,6 +670,27 @@ PathfindingGame::PathfindingGame(const GameParameters& params)
     num_players_ = grid_spec_.num_players;
   }
 
+  int seed = ParameterValue<int>("rng_seed", kDefaultRngSeed);
+  rng_.seed(seed == -1 ? std::random_device()() : seed);
+}
+
+uint64_t PathfindingGame::NewStreamSeed() const {
+  std::lock_guard<std::mutex> lock(rng_mutex_);
+  return rng_();
+}
+
+std::string PathfindingGame::GetRNGState() const {
+  std::lock_guard<std::mutex> lock(rng_mutex_);
+  std::ostringstream rng_stream;
+  rng_stream << rng_;
+  return rng_stream.str();
+}
+
+void PathfindingGame::SetRNGState(const std::string& rng_state) const {
+  if (rng_state.empty()) return;
+  std::lock_guard<std::mutex> lock(rng_mutex_);
+  std::istringstream rng_stream(rng_state);
+  rng_stream >> rng_;
 }
 
 }  // namespace pathfinding
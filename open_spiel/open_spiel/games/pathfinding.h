@@ -16,7 +16,10 @@
 #define OPEN_SPIEL_GAMES_PATHFINDING_H_
 
 #include <array>
+#include <cstdint>
 #include <memory>
+#include <mutex>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -46,6 +49,11 @@ namespace pathfinding {
 //                          (default: 100.0).
 //   "step_reward"  double  The reward given to every agent on each per step
 //                          (default: -0.01).
+//   "random_move_chance" double  Probability that the move of player 0 is
+//                          replaced by one of the two neighbouring actions
+//                          (default: 0.0).
+//   "rng_seed"     int     Seed of the random moves (default: -1, seeded
+//                          from std::random_device).
 //
 // Note: currently, the observations are current non-Markovian because the time
 // step is not included and the horizon is finite. This can be easily added as
@@ -73,6 +81,7 @@ constexpr double kDefaultStepReward = -0.01;
 constexpr double kDefaultSolveReward = 100.0;
 constexpr double kDefaultGroupReward = 100.0;
 constexpr double kDefaultRandomMoveChance = 0.0;
+constexpr int kDefaultRngSeed = -1;
 
 struct GridSpec {
   int num_rows;
@@ -117,6 +126,14 @@ class PathfindingGame : public SimMoveGame {
   double step_reward() const { return step_reward_; }
   double random_move_chance() const { return random_move_chance_;}
 
+  // The random moves of every state are drawn from a stream of its own, whose
+  // seed is drawn from the game's generator when the initial state is
+  // created, so that an episode replays exactly given the game's RNG state.
+  // Thread-safe.
+  uint64_t NewStreamSeed() const;
+  std::string GetRNGState() const override;
+  void SetRNGState(const std::string& rng_state) const override;
+
  private:
   GridSpec grid_spec_;
   int num_players_;
@@ -127,6 +144,8 @@ class PathfindingGame : public SimMoveGame {
   std::vector<Action> legal_actions_;
   double random_move_chance_;
   std::string string_grid;
+  mutable std::mutex rng_mutex_;
+  mutable std::mt19937_64 rng_;
 };
 
 class PathfindingState : public SimMoveState {
@@ -137,6 +156,7 @@ class PathfindingState : public SimMoveState {
 
   std::string ActionToString(int player, Action action_id) const override;
   std::string ToString() const override;
+  uint64_t HashKey() const override { return hash_; }
   bool IsTerminal() const override;
   std::vector<double> Rewards() const override;
   std::vector<double> Returns() const override;
@@ -157,6 +177,21 @@ class PathfindingState : public SimMoveState {
 
   Player PlayerAtPos(const std::pair<int, int>& coord) const;
 
+  int NumRows() const { return grid_spec_.num_rows; }
+  int NumCols() const { return grid_spec_.num_cols; }
+
+  // Contents of an in-bounds cell: the player on it, kEmpty or kWall.
+  int CellAt(int row, int col) const { return grid_[row][col]; }
+
+  // Compact identifier of the state: the cell index (row * num_cols + col) of
+  // every player, packed in the fewest bits that fit any cell, player 0 in
+  // the lowest bits. Among states of the same game it distinguishes exactly
+  // the states ToString() distinguishes. With with_move_count the number of
+  // moves played is packed above the positions, which makes the key
+  // Markovian for the finite horizon. Fails if the key does not fit in 64
+  // bits.
+  uint64_t CompactKey(bool with_move_count = false) const;
+
  protected:
   void DoApplyAction(Action action_id) override;
   void DoApplyActions(const std::vector<Action>& moves) override;
@@ -179,6 +214,9 @@ class PathfindingState : public SimMoveState {
   int horizon_;
   std::vector<std::pair<int, int>> player_positions_;
 
+  // Zobrist hash of player_positions_, which are what ToString shows.
+  uint64_t hash_ = 0;
+
   // The state of the board. Coordinates indices are in row-major order.
   // - Values from 0 to num_players - 1 refer to the player.
   // - Otherwise the value is above (kEmpty or kWall).
@@ -197,6 +235,13 @@ class PathfindingState : public SimMoveState {
 
   // Has the player reached the destination? (1 if yes, 0 if no).
   std::vector<int> reached_destinations_;
+
+  // Stream of the random moves: the i-th draw is a fixed function of
+  // (rng_stream_, i), so copies of a state draw the same moves and a state is
+  // cheap to copy.
+  double NextUniform();
+  uint64_t rng_stream_;
+  uint64_t rng_counter_ = 0;
 };
 
 }  // namespace pathfinding
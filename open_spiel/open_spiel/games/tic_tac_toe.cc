@@ -21,11 +21,19 @@
 
 #include "open_spiel/spiel_utils.h"
 #include "open_spiel/utils/tensor_view.h"
+#include "open_spiel/utils/zobrist.h"
 
 namespace open_spiel {
 namespace tic_tac_toe {
 namespace {
 
+constexpr uint64_t kZobristSalt = 0x7469637461637465ULL;
+
+// Zobrist key of a mark of player on cell.
+uint64_t MarkKey(int cell, Player player) {
+  return ZobristKey(kZobristSalt, cell * kNumPlayers + player);
+}
+
 // Facts about the game.
 const GameType kGameType{
     /*short_name=*/"tic_tac_toe",
@@ -95,6 +103,7 @@ bool BoardHasLine(const std::array<CellState, kNumCells>& board,
 void TicTacToeState::DoApplyAction(Action move) {
   SPIEL_CHECK_EQ(board_[move], CellState::kEmpty);
   board_[move] = PlayerToState(CurrentPlayer());
+  hash_ ^= MarkKey(move, current_player_);
   if (HasLine(current_player_)) {
     outcome_ = current_player_;
   }
@@ -192,6 +201,7 @@ void TicTacToeState::ObservationTensor(Player player,
 
 void TicTacToeState::UndoAction(Player player, Action move) {
   board_[move] = CellState::kEmpty;
+  hash_ ^= MarkKey(move, player);
   current_player_ = player;
   outcome_ = kInvalidPlayer;
   num_moves_ -= 1;
@@ -16,6 +16,7 @@
 #define OPEN_SPIEL_GAMES_TIC_TAC_TOE_H_
 
 #include <array>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -61,6 +62,7 @@ class TicTacToeState : public State {
   }
   std::string ActionToString(Player player, Action action_id) const override;
   std::string ToString() const override;
+  uint64_t HashKey() const override { return hash_; }
   bool IsTerminal() const override;
   std::vector<double> Returns() const override;
   std::vector<double> Rewards() const override;
@@ -90,6 +92,7 @@ class TicTacToeState : public State {
   Player current_player_ = 0;         // Player zero goes first
   Player outcome_ = kInvalidPlayer;
   int num_moves_ = 0;
+  uint64_t hash_ = 0;                 // Zobrist hash of the marks on board_.
 };
 
 // Game object.
@@ -297,6 +297,10 @@ std::pair<Action, double> SampleAction(const ActionsAndProbs& outcomes,
       absl::StrCat("Internal error: failed to sample an outcome; z=", z));
 }
 
+uint64_t State::HashKey() const {
+  return std::hash<std::string>()(ToString());
+}
+
 std::string State::Serialize() const {
   // This simple serialization doesn't work for the following games:
   // - games with sampled chance nodes, since the history doesn't give us enough
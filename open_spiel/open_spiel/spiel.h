@@ -15,6 +15,7 @@
 #ifndef OPEN_SPIEL_SPIEL_H_
 #define OPEN_SPIEL_SPIEL_H_
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <map>
@@ -309,6 +310,14 @@ class State {
   // implementation of operator==.
   virtual std::string ToString() const = 0;
 
+  // Returns a 64-bit hash of the state, equal for states with the same
+  // ToString() and, up to hash collisions, different otherwise. It can key
+  // tables of states (transposition tables, Q-tables) without building the
+  // state string. The default hashes ToString(); games can override it with a
+  // hash maintained incrementally as actions are applied (see
+  // utils/zobrist.h).
+  virtual uint64_t HashKey() const;
+
   // Returns true if these states are equal, false otherwise. Two states are
   // equal if they are the same world state; the interpretation might differ
   // across games. For instance, in an imperfect information game, the full
@@ -0,0 +1,100 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/utils/binary_checkpoint.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "open_spiel/abseil-cpp/absl/strings/str_cat.h"
+#include "open_spiel/spiel_utils.h"
+
+namespace open_spiel {
+
+CheckpointWriter::CheckpointWriter() {
+  Write<uint32_t>(kCheckpointMagic);
+  Write<uint32_t>(kCheckpointVersion);
+}
+
+void CheckpointWriter::WriteString(absl::string_view str) {
+  Write<uint64_t>(str.size());
+  buffer_.append(str.data(), str.size());
+}
+
+void CheckpointWriter::Save(const std::string& path) const {
+  const std::string tmp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!file) SpielFatalError(absl::StrCat("Can not write ", tmp_path));
+    file.write(buffer_.data(), buffer_.size());
+    if (!file) SpielFatalError(absl::StrCat("Error writing ", tmp_path));
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    SpielFatalError(absl::StrCat("Can not rename ", tmp_path, " to ", path));
+  }
+}
+
+CheckpointReader::CheckpointReader(const std::string& path) : path_(path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) SpielFatalError(absl::StrCat("Can not open ", path));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    SpielFatalError(absl::StrCat("Can not stat ", path));
+  }
+  size_ = file_stat.st_size;
+  if (size_ > 0) {
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      SpielFatalError(absl::StrCat("Can not map ", path));
+    }
+    data_ = static_cast<const char*>(mapping);
+  }
+  close(fd);
+
+  if (size_ < 2 * sizeof(uint32_t) || Read<uint32_t>() != kCheckpointMagic) {
+    SpielFatalError(absl::StrCat(path, " is not a checkpoint"));
+  }
+  const uint32_t version = Read<uint32_t>();
+  if (version != kCheckpointVersion) {
+    SpielFatalError(absl::StrCat(path, " has checkpoint version ", version,
+                                 ", expected ", kCheckpointVersion));
+  }
+}
+
+CheckpointReader::~CheckpointReader() {
+  if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+}
+
+std::string CheckpointReader::ReadString() {
+  const uint64_t size = Read<uint64_t>();
+  return std::string(Consume(size), size);
+}
+
+const char* CheckpointReader::Consume(size_t num_bytes) {
+  if (num_bytes > size_ - position_) {
+    SpielFatalError(absl::StrCat("Truncated checkpoint ", path_));
+  }
+  const char* bytes = data_ + position_;
+  position_ += num_bytes;
+  return bytes;
+}
+
+}  // namespace open_spiel
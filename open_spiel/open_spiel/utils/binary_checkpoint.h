@@ -0,0 +1,135 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_UTILS_BINARY_CHECKPOINT_H_
+#define OPEN_SPIEL_UTILS_BINARY_CHECKPOINT_H_
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "open_spiel/abseil-cpp/absl/strings/string_view.h"
+#include "open_spiel/abseil-cpp/absl/types/span.h"
+#include "open_spiel/spiel_utils.h"
+
+namespace open_spiel {
+
+// Versioned binary checkpoint files. A file starts with a magic number and a
+// format version, followed by the values written by the caller in native
+// byte order: fixed-size scalars, length-prefixed strings and
+// length-prefixed arrays of scalars, which are stored contiguously so that
+// large tables are written and read with a single copy.
+//
+// Readers must read the values back in the order and with the types they
+// were written with; every read is bounds-checked and a mismatch is a fatal
+// error, as is a file of a different format version.
+inline constexpr uint32_t kCheckpointMagic = 0x4b434c51;  // "QLCK"
+inline constexpr uint32_t kCheckpointVersion = 2;
+
+class CheckpointWriter {
+ public:
+  CheckpointWriter();
+
+  template <typename T>
+  void Write(const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "Not a scalar");
+    buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteString(absl::string_view str);
+
+  template <typename T>
+  void WriteArray(absl::Span<const T> values) {
+    static_assert(std::is_trivially_copyable<T>::value, "Not a scalar");
+    Write<uint64_t>(values.size());
+    buffer_.append(reinterpret_cast<const char*>(values.data()),
+                   values.size() * sizeof(T));
+  }
+
+  // State of a random number engine of the standard library, in its text
+  // form, which is the only portable one.
+  template <typename Engine>
+  void WriteEngine(const Engine& engine) {
+    std::ostringstream stream;
+    stream << engine;
+    WriteString(stream.str());
+  }
+
+  // Writes the checkpoint to a temporary file next to path, then renames it
+  // over path, so that a crash never leaves a truncated checkpoint behind.
+  void Save(const std::string& path) const;
+
+  const std::string& data() const { return buffer_; }
+
+ private:
+  std::string buffer_;
+};
+
+class CheckpointReader {
+ public:
+  // Maps the file into memory; values are copied out of the mapping as they
+  // are read.
+  explicit CheckpointReader(const std::string& path);
+  ~CheckpointReader();
+
+  CheckpointReader(const CheckpointReader&) = delete;
+  CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+  template <typename T>
+  T Read() {
+    static_assert(std::is_trivially_copyable<T>::value, "Not a scalar");
+    T value;
+    std::memcpy(&value, Consume(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString();
+
+  template <typename T>
+  std::vector<T> ReadArray() {
+    static_assert(std::is_trivially_copyable<T>::value, "Not a scalar");
+    const uint64_t size = Read<uint64_t>();
+    std::vector<T> values(size);
+    if (size > 0) {
+      std::memcpy(values.data(), Consume(size * sizeof(T)), size * sizeof(T));
+    }
+    return values;
+  }
+
+  template <typename Engine>
+  void ReadEngine(Engine* engine) {
+    std::istringstream stream(ReadString());
+    stream >> *engine;
+    if (stream.fail()) SpielFatalError("Invalid random engine in checkpoint");
+  }
+
+  // Whether every value of the file has been read.
+  bool AtEnd() const { return position_ == size_; }
+
+ private:
+  // Returns the next num_bytes of the file and moves past them.
+  const char* Consume(size_t num_bytes);
+
+  std::string path_;
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+  size_t position_ = 0;
+};
+
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_UTILS_BINARY_CHECKPOINT_H_
@@ -0,0 +1,87 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "open_spiel/utils/thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace open_spiel {
+
+ThreadPool::ThreadPool(int num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers_.reserve(num_threads);
+  for (int w = 0; w < num_threads; ++w) {
+    workers_.emplace_back([this, w]() { WorkerLoop(w); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void(int worker)> fn) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    queue_.push(std::move(fn));
+    ++num_pending_;
+  }
+  work_available_.notify_one();
+}
+
+void ThreadPool::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return num_pending_ == 0; });
+}
+
+void ThreadPool::ParallelFor(
+    int n, const std::function<void(int i, int worker)>& fn) {
+  for (int i = 0; i < n; ++i) {
+    Schedule([&fn, i](int worker) { fn(i, worker); });
+  }
+  Wait();
+}
+
+void ThreadPool::WorkerLoop(int worker) {
+  while (true) {
+    std::function<void(int)> fn;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        // Only reached when stopping.
+        return;
+      }
+      fn = std::move(queue_.front());
+      queue_.pop();
+    }
+    fn(worker);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      --num_pending_;
+    }
+    work_done_.notify_all();
+  }
+}
+
+}  // namespace open_spiel
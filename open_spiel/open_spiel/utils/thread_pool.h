@@ -0,0 +1,64 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_UTILS_THREAD_POOL_H_
+#define OPEN_SPIEL_UTILS_THREAD_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace open_spiel {
+
+// A fixed-size pool of worker threads executing scheduled closures in FIFO
+// order. Each closure receives the index of the worker running it, in
+// [0, NumThreads()), which can be used to address per-worker state such as
+// random number generators.
+class ThreadPool {
+ public:
+  // num_threads <= 0 means one thread per hardware core.
+  explicit ThreadPool(int num_threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  int NumThreads() const { return workers_.size(); }
+
+  void Schedule(std::function<void(int worker)> fn);
+
+  // Blocks until every scheduled closure has finished.
+  void Wait();
+
+  // Runs fn(i, worker) for every i in [0, n) and waits for all of them.
+  void ParallelFor(int n, const std::function<void(int i, int worker)>& fn);
+
+ private:
+  void WorkerLoop(int worker);
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void(int)>> queue_;
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  int num_pending_ = 0;
+  bool stop_ = false;
+};
+
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_UTILS_THREAD_POOL_H_
@@ -0,0 +1,39 @@
+// Copyright 2021 DeepMind Technologies Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPEN_SPIEL_UTILS_ZOBRIST_H_
+#define OPEN_SPIEL_UTILS_ZOBRIST_H_
+
+#include <cstdint>
+
+namespace open_spiel {
+
+// Pseudo-random 64-bit key of a feature of a state (e.g. "player 1 is on cell
+// 12"), for Zobrist hashing: the hash of a state is the XOR of the keys of its
+// features, so it is updated in O(1) by XOR-ing out the keys of the removed
+// features and XOR-ing in the keys of the added ones.
+//
+// Keys are a fixed function (the SplitMix64 finalizer) of the salt, which
+// tells apart the kinds of features of a game, and of the feature, so they
+// need no table and are the same on every run and platform.
+inline uint64_t ZobristKey(uint64_t salt, uint64_t feature) {
+  uint64_t z = salt * 0x9E3779B97F4A7C15ULL + feature + 1;
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+}  // namespace open_spiel
+
+#endif  // OPEN_SPIEL_UTILS_ZOBRIST_H_